@@ -0,0 +1,62 @@
+#include <stdio.h>
+#include "raylib.h"
+#include "assets.h"
+
+// build step: decodes the spritesheet once and writes it out as an rgba8 C array
+// usage: assetpack SPRITESHEET OUT.c
+
+#define SPRITE_NAME(name, x, y, w, h) #name,
+
+static const char *sprite_names[SPRITE_COUNT] = {
+    SPRITE_REGIONS(SPRITE_NAME)
+};
+
+int main(int argc, char* argv[])
+{
+    if (argc != 3) {
+        printf("usage: %s SPRITESHEET OUT.c\n", argv[0]);
+        return -1;
+    }
+    SetTraceLogLevel(LOG_WARNING);
+    Image image = LoadImage(argv[1]);
+    if (!IsImageValid(image)) {
+        printf("Couldn't load %s\n", argv[1]);
+        return -1;
+    }
+    ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+
+    // a region off the sheet would silently sample clamped edge pixels at runtime
+    for (int i = 0; i < SPRITE_COUNT; i++) {
+        Rectangle r = sprite_regions[i];
+        if (r.x < 0 || r.y < 0 || r.x + r.width > image.width || r.y + r.height > image.height) {
+            printf("%s lies outside the %dx%d sheet\n", sprite_names[i], image.width, image.height);
+            UnloadImage(image);
+            return -1;
+        }
+    }
+
+    FILE *f = fopen(argv[2], "w");
+    if (!f) {
+        printf("Couldn't open %s\n", argv[2]);
+        UnloadImage(image);
+        return -1;
+    }
+    fprintf(f, "// generated by assetpack from %s, do not edit\n", argv[1]);
+    fprintf(f, "#include \"assets.h\"\n\n");
+    fprintf(f, "const int spritesheet_width = %d;\n", image.width);
+    fprintf(f, "const int spritesheet_height = %d;\n", image.height);
+    fprintf(f, "const unsigned char spritesheet_pixels[] = {");
+    const unsigned char *bytes = image.data;
+    int size = image.width * image.height * 4;
+    for (int i = 0; i < size; i++) {
+        fprintf(f, "%s%u,", (i % 24 == 0) ? "\n    " : "", bytes[i]);
+    }
+    fprintf(f, "\n};\n");
+    bool ok = fclose(f) == 0;
+    UnloadImage(image);
+    if (!ok) {
+        printf("Couldn't write %s\n", argv[2]);
+        return -1;
+    }
+    return 0;
+}
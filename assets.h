@@ -0,0 +1,35 @@
+#ifndef ASSETS_H
+#define ASSETS_H
+
+#include "raylib.h"
+
+// the spritesheet ships inside the binary, decoded to rgba8 at build time by
+// assetpack (see the Makefile), so startup is a straight texture upload
+
+// name, x, y, width, height in spritesheet pixels
+#define SPRITE_REGIONS(X)                   \
+    X(SPRITE_CANNON,   0,   232, 32, 32)    \
+    X(SPRITE_BULLET,   48,  64,  32, 32)    \
+    X(SPRITE_PLANK,    0,   64,  48, 136)   \
+    X(SPRITE_WATER_0,  0,   200, 32, 32)    \
+    X(SPRITE_WATER_1,  32,  200, 32, 32)    \
+    X(SPRITE_WATER_2,  64,  200, 32, 32)
+
+#define SPRITE_ENUM(name, x, y, w, h) name,
+#define SPRITE_RECT(name, x, y, w, h) {x, y, w, h},
+
+typedef enum {
+    SPRITE_REGIONS(SPRITE_ENUM)
+    SPRITE_COUNT
+} SpriteId;
+
+static const Rectangle sprite_regions[SPRITE_COUNT] = {
+    SPRITE_REGIONS(SPRITE_RECT)
+};
+
+// generated into assets_data.c
+extern const int spritesheet_width;
+extern const int spritesheet_height;
+extern const unsigned char spritesheet_pixels[];
+
+#endif
@@ -0,0 +1,100 @@
+#include <math.h>
+#include "background.h"
+#include "render.h"
+#include "assets.h"
+#include "sim.h"
+
+// render textures are stored bottom up, region is in top down target pixels
+static Rectangle target_source(RenderTexture2D target, Rectangle region)
+{
+    return (Rectangle) {
+        region.x,
+        target.texture.height - region.y - region.height,
+        region.width,
+        -region.height
+    };
+}
+
+static void bake_water(RenderTexture2D target, Texture2D spritesheet, int frame)
+{
+    Rectangle tile_source = sprite_regions[SPRITE_WATER_0 + frame];
+    render_target_begin(target);
+    render_clear(BLANK);
+    render_begin();
+    for (int y = 0; y < (GAME_HEIGHT + WATER_TILE_SIZE) / WATER_TILE_SIZE; y++) {
+        for (int x = 0; x < (GAME_WIDTH + WATER_TILE_SIZE) / WATER_TILE_SIZE; x++) {
+            Rectangle dest_tile = {x * WATER_TILE_SIZE, y * WATER_TILE_SIZE, WATER_TILE_SIZE, WATER_TILE_SIZE};
+            render_texture(LAYER_BACKGROUND, spritesheet, tile_source, dest_tile, (Vector2) {0,0}, WHITE);
+        }
+    }
+    render_flush();
+    render_target_end();
+}
+
+static void bake_plank(RenderTexture2D target, Texture2D spritesheet)
+{
+    Rectangle source = sprite_regions[SPRITE_PLANK];
+    render_target_begin(target);
+    render_clear(BLANK);
+    render_begin();
+    for (int i = 0; i < 2; i++) {
+        Rectangle dest = {0, i * plank_rect.height, plank_rect.width, plank_rect.height};
+        render_texture(LAYER_BACKGROUND, spritesheet, source, dest, (Vector2) {0,0}, WHITE);
+    }
+    render_flush();
+    render_target_end();
+}
+
+bool background_bake(Background *bg, Texture2D spritesheet)
+{
+    *bg = (Background) {0};
+    for (int i = 0; i < WATER_FRAMES; i++) {
+        bg->water[i] = render_target_load(GAME_WIDTH, GAME_HEIGHT);
+        if (!render_target_valid(bg->water[i])) {
+            background_unload(bg);
+            return false;
+        }
+        bake_water(bg->water[i], spritesheet, i);
+    }
+    bg->plank = render_target_load((int) plank_rect.width, 2 * (int) plank_rect.height);
+    if (!render_target_valid(bg->plank)) {
+        background_unload(bg);
+        return false;
+    }
+    bake_plank(bg->plank, spritesheet);
+    return true;
+}
+
+void background_update(Background *bg, float dt)
+{
+    bg->frame_timer += dt;
+    if (bg->frame_timer > WATER_FRAME_TIME) {
+        bg->frame_timer = 0.0f;
+        bg->frame = (bg->frame + 1) % WATER_FRAMES;
+    }
+}
+
+void background_draw_water(const Background *bg)
+{
+    RenderTexture2D target = bg->water[bg->frame];
+    Rectangle screen = {0, 0, GAME_WIDTH, GAME_HEIGHT};
+    render_texture(LAYER_BACKGROUND, target.texture, target_source(target, screen), screen, (Vector2) {0,0}, WHITE);
+}
+
+// scroll moves the plank down, so the window slides up the stacked strip
+void background_draw_plank(const Background *bg, float scroll)
+{
+    float offset = fmodf(scroll, plank_rect.height);
+    if (offset < 0) offset += plank_rect.height;
+    Rectangle window = {0, plank_rect.height - offset, plank_rect.width, plank_rect.height};
+    render_texture(LAYER_PLANK, bg->plank.texture, target_source(bg->plank, window), plank_rect, (Vector2) {0,0}, WHITE);
+}
+
+void background_unload(Background *bg)
+{
+    for (int i = 0; i < WATER_FRAMES; i++) {
+        if (render_target_valid(bg->water[i])) render_target_unload(bg->water[i]);
+    }
+    if (render_target_valid(bg->plank)) render_target_unload(bg->plank);
+    *bg = (Background) {0};
+}
@@ -0,0 +1,28 @@
+#ifndef BACKGROUND_H
+#define BACKGROUND_H
+
+#include <stdbool.h>
+#include "raylib.h"
+
+// the water animation and the plank strip only ever show a handful of unique
+// images, so they are drawn once into render textures at startup and each
+// frame composites the right one instead of redrawing every tile
+
+#define WATER_FRAMES 3
+#define WATER_FRAME_TIME 0.2f
+#define WATER_TILE_SIZE 128
+
+typedef struct background {
+    RenderTexture2D water[WATER_FRAMES];
+    RenderTexture2D plank;          // two plank lengths stacked, scrolling is a window into it
+    int frame;
+    float frame_timer;
+} Background;
+
+bool background_bake(Background *bg, Texture2D spritesheet);
+void background_update(Background *bg, float dt);
+void background_draw_water(const Background *bg);
+void background_draw_plank(const Background *bg, float scroll);
+void background_unload(Background *bg);
+
+#endif
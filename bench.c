@@ -0,0 +1,304 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+#include "timing.h"
+#include "simd.h"
+#include "savestate.h"
+
+// per-subsystem microbenchmarks over scripted scenarios, one json object per line
+// usage: 20g_plank_bench [--scenario NAME] [--samples N] [--warmup N] [--ticks N] [--out FILE] [--simd scalar|sse2|avx2] [--state FILE]
+// --state adds a "state" scenario that starts from a save state written by the headless driver
+
+typedef void (*ScenarioSetup)(World *w);
+
+typedef struct scenario {
+    const char *name;
+    ScenarioSetup setup;
+} Scenario;
+
+typedef enum {
+    FN_UPDATE_PLAYER,
+    FN_UPDATE_CANNONS,
+    FN_COLLIDE,
+    FN_UPDATE_CRATES,
+    FN_UPDATE_BOXES,
+    FN_UPDATE_PLANKS,
+    FN_BUMP_COLLISION,
+    FN_SIM_STEP,
+    FN_COUNT
+} BenchFunction;
+
+static const char *function_names[FN_COUNT] = {
+    "update_player",
+    "update_cannons",
+    "collide",
+    "update_crates",
+    "update_boxes",
+    "update_planks",
+    "bump_collision",
+    "sim_step",
+};
+
+typedef struct bench_config {
+    int samples;
+    int warmup;
+    int ticks_per_sample;
+    const char *scenario;
+    FILE *out;
+} BenchConfig;
+
+static World saved_state;
+
+static void setup_idle(World *w)
+{
+    (void) w;
+}
+
+static void setup_cannons_firing(World *w)
+{
+    Bullets *bullets = &w->bullets;
+    Vector2 target = {w->player.dest_rect.x + 0.5f * PLAYER_SIZE, w->player.dest_rect.y + 0.5f * PLAYER_SIZE};
+    for (int i = 0; i < w->params.cannons; i++) {
+        int n = pool_spawn(&bullets->pool);
+        if (n < 0) break;
+        BulletHandler *b = &w->cannons.bullet[i];
+        b->state = FIRING;
+        b->timer = 0.0f;
+        b->bullet_position = (Vector2) {w->cannons.x[i], w->cannons.y[i]};
+        b->lock_on = target;
+        b->bullet = bullets->pool.handles[n];
+        bullets->x[n] = b->bullet_position.x;
+        bullets->y[n] = b->bullet_position.y;
+        bullets->from_x[n] = b->bullet_position.x;
+        bullets->from_y[n] = b->bullet_position.y;
+        bullets->target_x[n] = target.x;
+        bullets->target_y[n] = target.y;
+        bullets->speed[n] = b->speed;
+        bullets->state[n] = FIRING;
+        bullets->owner[n] = i;
+    }
+}
+
+static void setup_crates_full(World *w)
+{
+    for (int i = 0; i < w->params.crates; i++) {
+        int n = pool_spawn(&w->crates.pool);
+        if (n < 0) break;
+        w->crates.x[n] = plank_rect.x + (i % 2) * (PLANK_W - CRATE_SIZE);
+        w->crates.y[n] = (float) (i * (GAME_HEIGHT - PLAYER_SIZE) / w->params.crates) - CRATE_SIZE;
+    }
+}
+
+static void setup_boxes_full(World *w)
+{
+    for (int i = 0; i < w->params.boxes; i++) {
+        spawn_box(w, (Vector2) {
+            plank_rect.x + (i % 3) * CRATE_SIZE,
+            (float) ((i / 3) * CRATE_SIZE) - CRATE_SIZE
+        });
+    }
+}
+
+static void setup_planks_zooming(World *w)
+{
+    for (int i = 0; i < w->params.planks; i++) {
+        spawn_plank(w, (Vector2) {plank_rect.x + i * 20.0f, 40.0f * i});
+    }
+    for (int i = 0; i < w->planks.pool.count; i++) {
+        w->planks.state[i] = ZOOMING;
+    }
+}
+
+static void setup_everything(World *w)
+{
+    setup_crates_full(w);
+    setup_boxes_full(w);
+    setup_planks_zooming(w);
+    setup_cannons_firing(w);
+}
+
+static void setup_saved_state(World *w)
+{
+    *w = saved_state;
+}
+
+static const Scenario scenarios[] = {
+    {"idle", setup_idle},
+    {"cannons_firing", setup_cannons_firing},
+    {"crates_full", setup_crates_full},
+    {"boxes_full", setup_boxes_full},
+    {"planks_zooming", setup_planks_zooming},
+    {"everything", setup_everything},
+    {"state", setup_saved_state},
+};
+
+// debug mode keeps the player alive so scenarios are not cut short by a reset
+static void build_scenario(World *w, const Scenario *s)
+{
+    sim_init(w, 1234);
+    w->debug_mode = true;
+    w->game_state = IN_GAME;
+    s->setup(w);
+    sim_rebuild_spatial(w);
+}
+
+// sways left and right so the player both moves and bumps into things
+static SimInput scripted_input(int tick)
+{
+    SimInput input = {.debug = true};
+    if ((tick / 32) % 2 == 0) input.left = true;
+    else input.right = true;
+    input.space_pressed = (tick % 16) == 0;
+    return input;
+}
+
+static void run_function(World *w, BenchFunction fn, int tick)
+{
+    switch (fn) {
+        case FN_UPDATE_PLAYER:
+            update_player(w, scripted_input(tick), SIM_DT);
+            break;
+        case FN_UPDATE_CANNONS:
+            update_cannons(w, SIM_DT);
+            break;
+        case FN_COLLIDE: {
+            Contacts contacts;
+            collect_contacts(w, &contacts);
+            resolve_contacts(w, &contacts, scripted_input(tick));
+        } break;
+        case FN_UPDATE_CRATES:
+            update_scroll(w, SIM_DT);
+            update_crates(w, SIM_DT);
+            break;
+        case FN_UPDATE_BOXES:
+            update_scroll(w, SIM_DT);
+            update_boxes(w, SIM_DT);
+            break;
+        case FN_UPDATE_PLANKS:
+            update_planks(w, SIM_DT);
+            break;
+        case FN_BUMP_COLLISION: {
+            Rectangle c = w->player.colliders[TOP];
+            Rectangle obstacle = {c.x + 0.5f * c.width, c.y + 0.25f * c.height, CRATE_SIZE, CRATE_SIZE};
+            bump_collision(&w->player, obstacle);
+        } break;
+        case FN_SIM_STEP:
+            sim_step(w, scripted_input(tick), SIM_DT);
+            break;
+        default:
+            break;
+    }
+}
+
+static int compare_double(const void *a, const void *b)
+{
+    double x = *(const double *) a;
+    double y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+
+static double percentile(const double *sorted, int n, double p)
+{
+    double rank = p * (n - 1);
+    int lo = (int) rank;
+    int hi = (lo + 1 < n) ? lo + 1 : lo;
+    double frac = rank - lo;
+    return sorted[lo] + (sorted[hi] - sorted[lo]) * frac;
+}
+
+static void bench(const BenchConfig *cfg, const Scenario *s, BenchFunction fn, double *samples)
+{
+    static World template_world;
+    static World world;
+    build_scenario(&template_world, s);
+
+    for (int sample = -cfg->warmup; sample < cfg->samples; sample++) {
+        world = template_world;
+        // the functions run without sim_step, which would sync the grid itself
+        sim_sync_grid(&world);
+        uint64_t start = timing_now_ns();
+        for (int tick = 0; tick < cfg->ticks_per_sample; tick++) {
+            run_function(&world, fn, tick);
+        }
+        uint64_t elapsed = timing_now_ns() - start;
+        if (sample >= 0) samples[sample] = (double) elapsed / cfg->ticks_per_sample;
+    }
+
+    qsort(samples, cfg->samples, sizeof(double), compare_double);
+    double sum = 0.0;
+    for (int i = 0; i < cfg->samples; i++) sum += samples[i];
+
+    fprintf(cfg->out,
+        "{\"scenario\":\"%s\",\"function\":\"%s\",\"simd\":\"%s\",\"samples\":%d,\"warmup\":%d,\"ticks_per_sample\":%d,"
+        "\"ns_per_tick\":{\"mean\":%.2f,\"min\":%.2f,\"p50\":%.2f,\"p90\":%.2f,\"p99\":%.2f,\"max\":%.2f}}\n",
+        s->name, function_names[fn], simd.name, cfg->samples, cfg->warmup, cfg->ticks_per_sample,
+        sum / cfg->samples, samples[0], percentile(samples, cfg->samples, 0.5),
+        percentile(samples, cfg->samples, 0.9), percentile(samples, cfg->samples, 0.99),
+        samples[cfg->samples - 1]);
+}
+
+int main(int argc, char* argv[])
+{
+    BenchConfig cfg = {
+        .samples = 200,
+        .warmup = 20,
+        .ticks_per_sample = 64,
+        .scenario = NULL,
+        .out = stdout,
+    };
+    const char *state_path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--samples") == 0 && i + 1 < argc) {
+            cfg.samples = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) {
+            cfg.warmup = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) {
+            cfg.ticks_per_sample = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--scenario") == 0 && i + 1 < argc) {
+            cfg.scenario = argv[++i];
+        } else if (strcmp(argv[i], "--simd") == 0 && i + 1 < argc) {
+            if (!simd_select(argv[++i])) {
+                printf("simd variant %s isn't available on this cpu\n", argv[i]);
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--state") == 0 && i + 1 < argc) {
+            state_path = argv[++i];
+        } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            cfg.out = fopen(argv[++i], "w");
+            if (!cfg.out) {
+                printf("Couldn't open %s\n", argv[i]);
+                return -1;
+            }
+        } else {
+            printf("usage: %s [--scenario NAME] [--samples N] [--warmup N] [--ticks N] [--out FILE] [--simd scalar|sse2|avx2] [--state FILE]\n", argv[0]);
+            return -1;
+        }
+    }
+    if (cfg.samples < 1) cfg.samples = 1;
+    if (cfg.warmup < 0) cfg.warmup = 0;
+    if (cfg.ticks_per_sample < 1) cfg.ticks_per_sample = 1;
+    if (state_path && !save_state_load(state_path, &saved_state, NULL)) {
+        printf("Couldn't load save state %s, it is missing or from a different build\n", state_path);
+        return -1;
+    }
+
+    double *samples = malloc(sizeof(double) * cfg.samples);
+    if (!samples) return -1;
+
+    int ran = 0;
+    for (size_t s = 0; s < sizeof(scenarios) / sizeof(scenarios[0]); s++) {
+        if (cfg.scenario && strcmp(cfg.scenario, scenarios[s].name) != 0) continue;
+        if (scenarios[s].setup == setup_saved_state && !state_path) continue;
+        for (int fn = 0; fn < FN_COUNT; fn++) {
+            bench(&cfg, &scenarios[s], (BenchFunction) fn, samples);
+        }
+        ran++;
+    }
+    if (ran == 0) printf("No scenario named %s\n", cfg.scenario);
+
+    free(samples);
+    if (cfg.out != stdout) fclose(cfg.out);
+    return ran > 0 ? 0 : -1;
+}
@@ -0,0 +1,200 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bot.h"
+#include "simd.h"
+#include "timing.h"
+
+#define DEATH_SCORE -1000000.0f
+#define DANGER_MARGIN (0.5f * PLAYER_SIZE + BULLET_RADIUS + 16.0f)
+#define EDGE_MARGIN 24.0f
+
+// action a holds arrows[a % 9], a >= 9 adds space
+static const SimInput arrows[9] = {
+    {0},
+    {.up = true},
+    {.down = true},
+    {.left = true},
+    {.right = true},
+    {.up = true, .left = true},
+    {.up = true, .right = true},
+    {.down = true, .left = true},
+    {.down = true, .right = true},
+};
+
+static SimInput action_input(int action, bool first_tick)
+{
+    SimInput input = arrows[action % 9];
+    input.space_pressed = first_tick && action >= 9;
+    return input;
+}
+
+static float segment_distance(Vector2 p, Vector2 a, Vector2 b)
+{
+    float dx = b.x - a.x, dy = b.y - a.y;
+    float len2 = dx * dx + dy * dy;
+    float t = (len2 > 0.0f) ? ((p.x - a.x) * dx + (p.y - a.y) * dy) / len2 : 0.0f;
+    if (t < 0.0f) t = 0.0f;
+    if (t > 1.0f) t = 1.0f;
+    float ex = a.x + t * dx - p.x, ey = a.y + t * dy - p.y;
+    return sqrtf(ex * ex + ey * ey);
+}
+
+// planks held and boxes placed, cannons knocked out by reflected shots, minus standing
+// on a shot's path or near the plank edge; a line of play that dies is worth nothing
+static float score(const World *w)
+{
+    const Player *p = &w->player;
+    Vector2 centre = {p->dest_rect.x + 0.5f * PLAYER_SIZE, p->dest_rect.y + 0.5f * PLAYER_SIZE};
+    float s = 100.0f * p->inventory + 150.0f * w->boxes.pool.count;
+    for (int i = 0; i < w->params.cannons; i++) s += 1000.0f * (2 - w->cannons.health[i]);
+
+    const Bullets *bullets = &w->bullets;
+    for (int i = 0; i < bullets->pool.count; i++) {
+        Vector2 from = {bullets->x[i], bullets->y[i]};
+        Vector2 to = {bullets->target_x[i], bullets->target_y[i]};
+        float d = segment_distance(centre, from, to);
+        if (d < DANGER_MARGIN) s -= 2000.0f * (DANGER_MARGIN - d) / DANGER_MARGIN;
+    }
+
+    float left = centre.x - plank_rect.x;
+    float right = plank_rect.x + PLANK_W - centre.x;
+    float edge = (left < right) ? left : right;
+    if (edge < EDGE_MARGIN) s -= 50.0f * (EDGE_MARGIN - edge);
+
+    // drift towards the nearest crate so there is something to break
+    float nearest = GAME_WIDTH + GAME_HEIGHT;
+    for (int i = 0; i < w->crates.pool.count; i++) {
+        float dx = w->crates.x[i] + 0.5f * CRATE_SIZE - centre.x;
+        float dy = w->crates.y[i] + w->scroll + 0.5f * CRATE_SIZE - centre.y;
+        float d = fabsf(dx) + fabsf(dy);
+        if (d < nearest) nearest = d;
+    }
+    if (w->crates.pool.count > 0) s -= 0.2f * nearest;
+    return s;
+}
+
+typedef struct expand_job {
+    Bot *bot;
+    int depth;
+} ExpandJob;
+
+static void expand_range(void *ctx, int begin, int end)
+{
+    ExpandJob *job = ctx;
+    Bot *bot = job->bot;
+    uint64_t clone_ns = 0;
+    for (int k = begin; k < end; k++) {
+        const BotNode *parent = &bot->beam[k / BOT_ACTIONS];
+        BotNode *child = &bot->children[k];
+        int action = k % BOT_ACTIONS;
+        uint64_t start = timing_now_ns();
+        child->world = parent->world;
+        clone_ns += timing_now_ns() - start;
+        // the slot held another line, this thread's grid may still be that one
+        sim_sync_grid(&child->world);
+        child->first = (job->depth == 0) ? (uint8_t) action : parent->first;
+        child->dead = false;
+        for (int t = 0; t < BOT_REPEAT; t++) {
+            sim_step(&child->world, action_input(action, t == 0), SIM_DT);
+            if (!child->world.player.alive) {
+                child->dead = true;
+                break;
+            }
+        }
+        child->score = child->dead ? DEATH_SCORE + job->depth : score(&child->world);
+    }
+    __atomic_fetch_add(&bot->clones, (uint64_t) (end - begin), __ATOMIC_RELAXED);
+    __atomic_fetch_add(&bot->clone_ns, clone_ns, __ATOMIC_RELAXED);
+}
+
+typedef struct ranked {
+    float score;
+    int child;
+} Ranked;
+
+// best first, ties keep child order so the pick never depends on scheduling
+static int compare_ranked(const void *a, const void *b)
+{
+    const Ranked *x = a;
+    const Ranked *y = b;
+    if (x->score != y->score) return (x->score < y->score) ? 1 : -1;
+    return x->child - y->child;
+}
+
+static int plan(Bot *bot, const World *w)
+{
+    uint64_t start = timing_now_ns();
+    bot->beam[0].world = *w;
+    bot->beam[0].dead = false;
+    bot->beam_count = 1;
+    Ranked order[BOT_CHILDREN];
+    for (int depth = 0; depth < BOT_DEPTH; depth++) {
+        int children = bot->beam_count * BOT_ACTIONS;
+        ExpandJob job = {bot, depth};
+        task_pool_run(&bot->pool, children, 2, expand_range, &job);
+        bot->rollout_ticks += (uint64_t) children * BOT_REPEAT;
+
+        for (int k = 0; k < children; k++) order[k] = (Ranked) {bot->children[k].score, k};
+        qsort(order, children, sizeof(Ranked), compare_ranked);
+
+        // dead lines only survive when every line dies
+        int keep = 0;
+        for (int k = 0; k < children && keep < BOT_BEAM; k++) {
+            const BotNode *child = &bot->children[order[k].child];
+            if (child->dead && keep > 0) break;
+            bot->beam[keep++] = *child;
+            if (child->dead) break;
+        }
+        bot->beam_count = keep;
+        if (bot->beam[0].dead) break;
+    }
+    uint64_t took = timing_now_ns() - start;
+    bot->plans++;
+    bot->last_plan_ns = took;
+    bot->total_plan_ns += took;
+    if (took > bot->max_plan_ns) bot->max_plan_ns = took;
+    return bot->beam[0].first;
+}
+
+bool bot_init(Bot *bot, int threads)
+{
+    memset(bot, 0, sizeof(*bot));
+    bot->beam = malloc(BOT_BEAM * sizeof(BotNode));
+    bot->children = malloc(BOT_CHILDREN * sizeof(BotNode));
+    if (!bot->beam || !bot->children) {
+        bot_free(bot);
+        return false;
+    }
+    // the dispatch table is filled lazily by sim_init, do it before the workers race for it
+    simd_init();
+    if (!task_pool_init(&bot->pool, threads)) {
+        bot_free(bot);
+        return false;
+    }
+    return true;
+}
+
+// plans when the last action has been held long enough, space restarts from the menu
+SimInput bot_input(Bot *bot, const World *w)
+{
+    if (w->game_state != IN_GAME) {
+        bot->ticks_left = 0;
+        return (SimInput) {.space_pressed = true};
+    }
+    bool first = bot->ticks_left <= 0;
+    if (first) {
+        bot->action = plan(bot, w);
+        bot->ticks_left = BOT_REPEAT;
+    }
+    bot->ticks_left--;
+    return action_input(bot->action, first);
+}
+
+void bot_free(Bot *bot)
+{
+    if (bot->pool.count > 0) task_pool_free(&bot->pool);
+    free(bot->beam);
+    free(bot->children);
+    memset(bot, 0, sizeof(*bot));
+}
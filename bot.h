@@ -0,0 +1,49 @@
+#ifndef BOT_H
+#define BOT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sim.h"
+#include "taskpool.h"
+
+// beam search player: every BOT_REPEAT ticks it expands each of the best
+// BOT_BEAM lines of play by every action, steps a copy of the world through it,
+// keeps the best scoring children and repeats BOT_DEPTH times, then plays the
+// first action of the best line. expansions run on a task pool, and the result
+// doesn't depend on the thread count
+
+#define BOT_ACTIONS 18              // 9 arrow combinations including none, with and without space
+#define BOT_BEAM 8
+#define BOT_DEPTH 4
+#define BOT_REPEAT 10               // ticks an action is held, space only on the first
+#define BOT_CHILDREN (BOT_BEAM * BOT_ACTIONS)
+
+typedef struct bot_node {
+    World world;
+    float score;
+    uint8_t first;                  // action at the root of this line
+    bool dead;
+} BotNode;
+
+typedef struct bot {
+    BotNode *beam;                  // BOT_BEAM
+    BotNode *children;              // BOT_CHILDREN
+    int beam_count;
+    int action;                     // being played
+    int ticks_left;
+    // search stats since bot_init
+    uint64_t plans;
+    uint64_t last_plan_ns;
+    uint64_t max_plan_ns;
+    uint64_t total_plan_ns;
+    uint64_t rollout_ticks;
+    uint64_t clones;                // children copied from their parent
+    uint64_t clone_ns;              // spent in those copies, summed over the workers
+    TaskPool pool;
+} Bot;
+
+bool bot_init(Bot *bot, int threads);
+SimInput bot_input(Bot *bot, const World *w);
+void bot_free(Bot *bot);
+
+#endif
@@ -0,0 +1,67 @@
+#if !defined(_WIN32)
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include <string.h>
+#include "filemap.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+
+bool file_map(FileMap *m, const char *path)
+{
+    memset(m, 0, sizeof(*m));
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER size;
+    HANDLE mapping = NULL;
+    void *base = NULL;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0) mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping) base = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!base) {
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    m->base = base;
+    m->size = (size_t) size.QuadPart;
+    m->file = file;
+    m->mapping = mapping;
+    return true;
+}
+
+void file_unmap(FileMap *m)
+{
+    if (!m->base) return;
+    UnmapViewOfFile(m->base);
+    CloseHandle((HANDLE) m->mapping);
+    CloseHandle((HANDLE) m->file);
+    memset(m, 0, sizeof(*m));
+}
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+bool file_map(FileMap *m, const char *path)
+{
+    memset(m, 0, sizeof(*m));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    void *base = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) base = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return false;
+    m->base = base;
+    m->size = (size_t) st.st_size;
+    return true;
+}
+
+void file_unmap(FileMap *m)
+{
+    if (!m->base) return;
+    munmap(m->base, m->size);
+    memset(m, 0, sizeof(*m));
+}
+#endif
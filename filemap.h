@@ -0,0 +1,20 @@
+#ifndef FILEMAP_H
+#define FILEMAP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// read only view of a whole file. kept apart from anything that includes raylib.h,
+// windows.h and raylib declare some of the same names
+
+typedef struct file_map {
+    void *base;
+    size_t size;
+    void *file;                 // windows keeps the file and mapping handles open
+    void *mapping;
+} FileMap;
+
+bool file_map(FileMap *m, const char *path);
+void file_unmap(FileMap *m);
+
+#endif
@@ -0,0 +1,121 @@
+#include <string.h>
+#include "grid.h"
+
+typedef struct cell_range {
+    int x0, y0, x1, y1;         // rows are unwrapped, see wrap_row
+} CellRange;
+
+static inline int floor_cell(float v)
+{
+    float f = v * (1.0f / GRID_CELL_SIZE);
+    int c = (int) f;
+    return c - (f < c);
+}
+
+static inline int clamp_col(float v)
+{
+    int c = floor_cell(v);
+    if (c < 0) return 0;
+    return (c > GRID_COLS - 1) ? GRID_COLS - 1 : c;
+}
+
+static inline int wrap_row(int r)
+{
+    if ((unsigned) r < GRID_ROWS) return r;
+    r %= GRID_ROWS;
+    return (r < 0) ? r + GRID_ROWS : r;
+}
+
+// inclusive on both edges so touching bounds still share a cell
+static inline CellRange cell_range(Rectangle r)
+{
+    CellRange c = {
+        clamp_col(r.x),
+        floor_cell(r.y),
+        clamp_col(r.x + r.width),
+        floor_cell(r.y + r.height),
+    };
+    if (c.y1 - c.y0 >= GRID_ROWS) c.y1 = c.y0 + GRID_ROWS - 1;
+    return c;
+}
+
+void grid_clear(SpatialGrid *g, GridLayer layer)
+{
+    for (int k = 0; k < GRID_CELL_WORDS; k++) {
+        uint64_t used = g->used[layer][k];
+        while (used) {
+            memset(&g->cells[layer][64 * k + __builtin_ctzll(used)], 0, sizeof(GridMask));
+            used &= used - 1;
+        }
+        g->used[layer][k] = 0;
+    }
+}
+
+static void clear_range(SpatialGrid *g, GridLayer layer, int slot, CellRange c)
+{
+    uint64_t bit = 1ull << (slot & 63);
+    for (int y = c.y0, r = wrap_row(c.y0); y <= c.y1; y++, r = (r + 1 == GRID_ROWS) ? 0 : r + 1) {
+        GridMask *row = &g->cells[layer][r * GRID_COLS];
+        for (int x = c.x0; x <= c.x1; x++) row[x].bits[slot >> 6] &= ~bit;
+    }
+}
+
+static void set_range(SpatialGrid *g, GridLayer layer, int slot, CellRange c)
+{
+    uint64_t bit = 1ull << (slot & 63);
+    for (int y = c.y0, r = wrap_row(c.y0); y <= c.y1; y++, r = (r + 1 == GRID_ROWS) ? 0 : r + 1) {
+        int first = r * GRID_COLS;
+        GridMask *row = &g->cells[layer][first];
+        for (int x = c.x0; x <= c.x1; x++) {
+            row[x].bits[slot >> 6] |= bit;
+            g->used[layer][(first + x) >> 6] |= 1ull << ((first + x) & 63);
+        }
+    }
+}
+
+void grid_insert(SpatialGrid *g, GridLayer layer, int slot, Rectangle bounds)
+{
+    set_range(g, layer, slot, cell_range(bounds));
+}
+
+// bounds must be the ones the slot was inserted with
+void grid_remove(SpatialGrid *g, GridLayer layer, int slot, Rectangle bounds)
+{
+    clear_range(g, layer, slot, cell_range(bounds));
+}
+
+// most moves stay inside the same cells and cost two range computations
+void grid_move(SpatialGrid *g, GridLayer layer, int slot, Rectangle from, Rectangle to)
+{
+    CellRange a = cell_range(from);
+    CellRange b = cell_range(to);
+    if (a.x0 == b.x0 && a.y0 == b.y0 && a.x1 == b.x1 && a.y1 == b.y1) return;
+    clear_range(g, layer, slot, a);
+    set_range(g, layer, slot, b);
+}
+
+// slots registered anywhere near area, callers still run the exact test
+GridMask grid_query(const SpatialGrid *g, GridLayer layer, Rectangle area)
+{
+    GridMask slots = {{0}};
+    CellRange c = cell_range(area);
+    for (int y = c.y0, r = wrap_row(c.y0); y <= c.y1; y++, r = (r + 1 == GRID_ROWS) ? 0 : r + 1) {
+        const GridMask *row = &g->cells[layer][r * GRID_COLS];
+        for (int x = c.x0; x <= c.x1; x++) {
+            for (int k = 0; k < GRID_WORDS; k++) slots.bits[k] |= row[x].bits[k];
+        }
+    }
+    return slots;
+}
+
+// slot mask -> dense index mask, so walking the bits visits entities in pool order
+GridMask grid_dense(const EntityPool *p, GridMask slots)
+{
+    GridMask dense = {{0}};
+    int slot;
+    while ((slot = grid_mask_pop(&slots)) >= 0) {
+        int index = p->indices[slot];
+        if (index >= 0) dense.bits[index >> 6] |= 1ull << (index & 63);
+    }
+    return dense;
+}
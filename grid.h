@@ -0,0 +1,59 @@
+#ifndef GRID_H
+#define GRID_H
+
+#include <stdint.h>
+#include "raylib.h"
+#include "pool.h"
+
+// uniform grid broadphase over the playfield
+// every cell keeps one bitmask of pool slots per layer, an entity sets its bit
+// in each cell its bounds touch, so a query is the OR of a few cells and comes
+// back without duplicates. columns clamp to the border, rows wrap, so layers
+// kept in scrolling world coordinates never have to move anything.
+// the shipped limits fit one 64 bit word per mask, larger builds use more
+
+#define GRID_CELL_SIZE 64
+#define GRID_COLS 20                // 1280 / 64
+#define GRID_ROWS 12                // 720 / 64 rounded up, rows 768px apart share cells
+#define GRID_WORDS ((POOL_MAX_CAPACITY + 63) / 64)
+#define GRID_CELLS (GRID_ROWS * GRID_COLS)
+#define GRID_CELL_WORDS ((GRID_CELLS + 63) / 64)
+
+typedef enum {
+    GRID_CRATES = 0,
+    GRID_BOXES,
+    GRID_CANNONS,
+    GRID_LAYERS
+} GridLayer;
+
+typedef struct grid_mask {
+    uint64_t bits[GRID_WORDS];
+} GridMask;
+
+// used marks every cell an insert has touched since the last clear, so clearing a
+// sparse layer only visits the cells it has to
+typedef struct spatial_grid {
+    GridMask cells[GRID_LAYERS][GRID_CELLS];
+    uint64_t used[GRID_LAYERS][GRID_CELL_WORDS];
+} SpatialGrid;
+
+void grid_clear(SpatialGrid *g, GridLayer layer);
+void grid_insert(SpatialGrid *g, GridLayer layer, int slot, Rectangle bounds);
+void grid_remove(SpatialGrid *g, GridLayer layer, int slot, Rectangle bounds);
+void grid_move(SpatialGrid *g, GridLayer layer, int slot, Rectangle from, Rectangle to);
+GridMask grid_query(const SpatialGrid *g, GridLayer layer, Rectangle area);
+GridMask grid_dense(const EntityPool *p, GridMask slots);
+
+// clears and returns the lowest set bit, -1 once the mask is empty
+static inline int grid_mask_pop(GridMask *m)
+{
+    for (int k = 0; k < GRID_WORDS; k++) {
+        uint64_t b = m->bits[k];
+        if (!b) continue;
+        m->bits[k] = b & (b - 1);
+        return 64 * k + __builtin_ctzll(b);
+    }
+    return -1;
+}
+
+#endif
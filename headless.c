@@ -0,0 +1,310 @@
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "sim.h"
+#include "replay.h"
+#include "timing.h"
+#include "simd.h"
+#include "render.h"
+#include "render_soft.h"
+#include "scene.h"
+#include "savestate.h"
+#include "bot.h"
+
+// headless driver: steps the sim without a window as fast as the cpu allows
+// usage: 20g_plank_headless [--ticks N] [--seed S] [--dt SECONDS] [--record FILE | --replay FILE] [--simd scalar|sse2|avx2]
+//                            [--render] [--sheet FILE] [--write-frame FILE] [--golden FILE] [--golden-image FILE] [--write-golden FILE]
+//                            [--load-state FILE] [--save-state FILE] [--bot] [--threads N]
+// --render draws every FRAME_TICKS ticks through the software rasterizer, the last
+// frame can be written out, checked against a golden hash or compared pixel for pixel
+// against an image; `make golden` checks the reference hash in assets/.
+// --load-state starts from a save state instead of the seed, --save-state writes the last tick.
+// --bot plays with the beam search bot instead of wandering
+
+#define FRAME_TICKS 2
+// word hash of the frame, the reference is one line of text instead of megabytes of pixels
+static uint64_t frame_hash(const uint32_t *frame, int count)
+{
+    uint64_t h = 0x9E3779B97F4A7C15ull;
+    for (int i = 0; i < count; i++) {
+        h = (h ^ frame[i]) * 0xFF51AFD7ED558CCDull;
+        h ^= h >> 32;
+    }
+    return h;
+}
+
+// golden file: "WIDTHxHEIGHT HASH" in hex, written by --write-golden
+static bool write_golden(const char *path, const uint32_t *frame)
+{
+    FILE *f = fopen(path, "w");
+    if (!f) return false;
+    fprintf(f, "%dx%d %016llx\n", GAME_WIDTH, GAME_HEIGHT, (unsigned long long) frame_hash(frame, GAME_WIDTH * GAME_HEIGHT));
+    return fclose(f) == 0;
+}
+
+static int compare_golden(const char *path, const uint32_t *frame)
+{
+    FILE *f = fopen(path, "r");
+    int w = 0, h = 0;
+    unsigned long long expected = 0;
+    bool read = f && fscanf(f, "%dx%d %llx", &w, &h, &expected) == 3;
+    if (f) fclose(f);
+    if (!read) {
+        printf("Couldn't read golden hash %s\n", path);
+        return -1;
+    }
+    if (w != GAME_WIDTH || h != GAME_HEIGHT) {
+        printf("golden frame is %dx%d, frame is %dx%d\n", w, h, GAME_WIDTH, GAME_HEIGHT);
+        return -1;
+    }
+    uint64_t got = frame_hash(frame, w * h);
+    if (got != expected) {
+        printf("golden mismatch: frame hash %016llx, expected %016llx; --write-frame and --golden-image show where\n",
+            (unsigned long long) got, expected);
+        return 1;
+    }
+    printf("golden match\n");
+    return 0;
+}
+
+// pixel for pixel against an image from --write-frame, for tracking down a hash mismatch
+static int compare_golden_image(const char *path, const uint32_t *frame)
+{
+    int w, h;
+    uint32_t *golden = soft_image_read(path, &w, &h);
+    if (!golden) {
+        printf("Couldn't read golden image %s\n", path);
+        return -1;
+    }
+    if (w != GAME_WIDTH || h != GAME_HEIGHT) {
+        printf("golden image is %dx%d, frame is %dx%d\n", w, h, GAME_WIDTH, GAME_HEIGHT);
+        free(golden);
+        return -1;
+    }
+    int mismatched = 0;
+    int first = -1;
+    for (int i = 0; i < w * h; i++) {
+        if (golden[i] == frame[i]) continue;
+        if (first < 0) first = i;
+        mismatched++;
+    }
+    free(golden);
+    if (mismatched) printf("golden mismatch: %d pixels differ, first at %d,%d\n", mismatched, first % w, first / w);
+    else printf("golden image match\n");
+    return mismatched;
+}
+
+int main(int argc, char* argv[])
+{
+    long long ticks = -1;
+    uint64_t seed = (uint64_t) time(NULL);
+    float dt = SIM_DT;
+    const char *record_path = NULL;
+    const char *replay_path = NULL;
+    const char *sheet_path = NULL;
+    const char *frame_path = NULL;
+    const char *golden_path = NULL;
+    const char *golden_image_path = NULL;
+    const char *write_golden_path = NULL;
+    const char *load_path = NULL;
+    const char *save_path = NULL;
+    bool render = false;
+    bool use_bot = false;
+    int threads = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) {
+            ticks = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--dt") == 0 && i + 1 < argc) {
+            dt = (float) atof(argv[++i]);
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            record_path = argv[++i];
+        } else if (strcmp(argv[i], "--simd") == 0 && i + 1 < argc) {
+            if (!simd_select(argv[++i])) {
+                printf("simd variant %s isn't available on this cpu\n", argv[i]);
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replay_path = argv[++i];
+        } else if (strcmp(argv[i], "--render") == 0) {
+            render = true;
+        } else if (strcmp(argv[i], "--sheet") == 0 && i + 1 < argc) {
+            sheet_path = argv[++i];
+        } else if (strcmp(argv[i], "--write-frame") == 0 && i + 1 < argc) {
+            frame_path = argv[++i];
+            render = true;
+        } else if (strcmp(argv[i], "--golden") == 0 && i + 1 < argc) {
+            golden_path = argv[++i];
+            render = true;
+        } else if (strcmp(argv[i], "--golden-image") == 0 && i + 1 < argc) {
+            golden_image_path = argv[++i];
+            render = true;
+        } else if (strcmp(argv[i], "--write-golden") == 0 && i + 1 < argc) {
+            write_golden_path = argv[++i];
+            render = true;
+        } else if (strcmp(argv[i], "--load-state") == 0 && i + 1 < argc) {
+            load_path = argv[++i];
+        } else if (strcmp(argv[i], "--save-state") == 0 && i + 1 < argc) {
+            save_path = argv[++i];
+        } else if (strcmp(argv[i], "--bot") == 0) {
+            use_bot = true;
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else {
+            printf("usage: %s [--ticks N] [--seed S] [--dt SECONDS] [--record FILE | --replay FILE] [--simd scalar|sse2|avx2]\n"
+                   "       [--render] [--sheet FILE] [--write-frame FILE] [--golden FILE] [--golden-image FILE] [--write-golden FILE]\n"
+                   "       [--load-state FILE] [--save-state FILE] [--bot] [--threads N]\n", argv[0]);
+            return -1;
+        }
+    }
+
+    // a replay is a seed plus inputs from the first tick, it can't start from a save state
+    if (load_path && (replay_path || record_path)) {
+        printf("--load-state can't be combined with --record or --replay\n");
+        return -1;
+    }
+    // replays only ever step at SIM_DT, one recorded at another dt would play back a different game
+    if (record_path && dt != SIM_DT) {
+        printf("--dt can't be combined with --record\n");
+        return -1;
+    }
+
+    ReplayReader reader = {0};
+    ReplayWriter writer = {0};
+    if (replay_path) {
+        if (!replay_reader_open(&reader, replay_path)) {
+            printf("Couldn't open replay %s\n", replay_path);
+            return -1;
+        }
+        seed = reader.seed;
+        dt = SIM_DT;
+        if (ticks < 0) ticks = LLONG_MAX;
+    } else if (record_path && !replay_writer_open(&writer, record_path, seed)) {
+        printf("Couldn't open %s for recording\n", record_path);
+        return -1;
+    }
+
+    if (ticks < 0) ticks = 1000000;
+
+    static World world;
+    static World prev_world;
+    uint64_t start_ticks = 0;
+    if (load_path) {
+        uint64_t load_start = timing_now_ns();
+        if (!save_state_load(load_path, &world, &start_ticks)) {
+            printf("Couldn't load save state %s, it is missing or from a different build\n", load_path);
+            return -1;
+        }
+        sim_sync_grid(&world);
+        printf("loaded %s at tick %llu in %.1fus\n", load_path, (unsigned long long) start_ticks,
+            (double) (timing_now_ns() - load_start) * 1e-3);
+        simd_init();
+    } else {
+        sim_init(&world, seed);
+    }
+
+    Texture2D sheet = {0};
+    Background background = {0};
+    if (render) {
+        int sw = SOFT_SHEET_SIZE, sh = SOFT_SHEET_SIZE;
+        uint32_t *pixels = sheet_path ? soft_image_read(sheet_path, &sw, &sh) : soft_placeholder_sheet();
+        if (!pixels || !soft_init(GAME_WIDTH, GAME_HEIGHT)) {
+            printf("Couldn't set up the software renderer%s%s\n", sheet_path ? " or read " : "", sheet_path ? sheet_path : "");
+            free(pixels);
+            return -1;
+        }
+        sheet = soft_texture_load(pixels, sw, sh);
+        free(pixels);
+        if (!background_bake(&background, sheet)) {
+            printf("Couldn't bake background\n");
+            soft_shutdown();
+            return -1;
+        }
+    }
+    int frames = 0;
+    uint64_t render_ns = 0;
+    RenderStats render_stats = {0};
+    WanderInput wi = wander_init(seed);
+    static Bot bot;
+    if (use_bot && !bot_init(&bot, threads)) {
+        printf("Couldn't start the bot\n");
+        return -1;
+    }
+
+    int deaths = 0;
+    long long t = 0;
+    uint64_t start = timing_now_ns();
+    for (; t < ticks; t++) {
+        SimInput input;
+        if (replay_path) {
+            if (!replay_reader_next(&reader, &input)) break;
+        } else {
+            input = use_bot ? bot_input(&bot, &world) : wander_input(&wi);
+            replay_writer_push(&writer, input);
+        }
+        bool was_alive = world.player.alive;
+        bool frame = render && (t + 1) % FRAME_TICKS == 0;
+        if (frame) prev_world = world;
+        sim_step(&world, input, dt);
+        if (was_alive && !world.player.alive) deaths++;
+
+        // halfway between ticks so interpolation is exercised too
+        if (frame) {
+            uint64_t render_start = timing_now_ns();
+            background_update(&background, FRAME_TICKS * dt);
+            render_clear(C_BLUE);
+            render_begin();
+            scene_draw(&(Scene) {&world, &prev_world, 0.5f, sheet, &background, false});
+            render_flush();
+            render_ns += timing_now_ns() - render_start;
+            render_stats = render_last_stats();
+            frames++;
+        }
+    }
+    double elapsed = (double) (timing_now_ns() - start - render_ns) * 1e-9;
+    ticks = t;
+    replay_writer_close(&writer);
+    replay_reader_close(&reader);
+
+    printf("seed %llu\n", (unsigned long long) seed);
+    printf("simd %s\n", simd.name);
+    printf("ticks %lld in %.3fs (%.0f ticks/s)\n", ticks, elapsed, elapsed > 0 ? ticks / elapsed : 0.0);
+    printf("deaths %d, inventory %d, crates %d, boxes %d\n",
+        deaths, world.player.inventory, world.crates.pool.count, world.boxes.pool.count);
+    printf("checksum %016llx\n", (unsigned long long) sim_checksum(&world));
+    if (use_bot) {
+        printf("bot %llu plans on %d threads, mean %.2fms, max %.2fms, %.0f rollout ticks/s, clone %.0fns (%zu byte world)\n",
+            (unsigned long long) bot.plans, bot.pool.count, bot.plans ? bot.total_plan_ns * 1e-6 / bot.plans : 0.0,
+            bot.max_plan_ns * 1e-6, bot.total_plan_ns ? bot.rollout_ticks / (bot.total_plan_ns * 1e-9) : 0.0,
+            bot.clones ? (double) bot.clone_ns / bot.clones : 0.0, sizeof(World));
+        bot_free(&bot);
+    }
+    if (save_path) {
+        if (save_state_write(save_path, &world, start_ticks + (uint64_t) ticks)) printf("Wrote %s\n", save_path);
+        else printf("Couldn't write %s\n", save_path);
+    }
+
+    int status = 0;
+    if (render) {
+        double render_s = (double) render_ns * 1e-9;
+        printf("frames %d in %.3fs (%.0f frames/s), last frame %d draws in %d batches\n",
+            frames, render_s, render_s > 0 ? frames / render_s : 0.0, render_stats.draws, render_stats.batches);
+        if (frame_path) {
+            if (soft_image_write(frame_path, soft_framebuffer(), GAME_WIDTH, GAME_HEIGHT)) printf("Wrote %s\n", frame_path);
+            else printf("Couldn't write %s\n", frame_path);
+        }
+        if (write_golden_path) {
+            if (write_golden(write_golden_path, soft_framebuffer())) printf("Wrote %s\n", write_golden_path);
+            else printf("Couldn't write %s\n", write_golden_path);
+        }
+        if (golden_path && compare_golden(golden_path, soft_framebuffer()) != 0) status = 1;
+        if (golden_image_path && compare_golden_image(golden_image_path, soft_framebuffer()) != 0) status = 1;
+        background_unload(&background);
+        soft_shutdown();
+    }
+    return status;
+}
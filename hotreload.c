@@ -0,0 +1,157 @@
+#if !defined(_WIN32)
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "hotreload.h"
+#include "timing.h"
+
+#if defined(__linux__)
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#define HOT_RELOAD_INOTIFY 1
+#endif
+
+#define POLL_MS 200
+#define SETTLE_MS 50            // editors write in bursts, let the last one land
+
+static bool still_running(HotReload *hr)
+{
+    pthread_mutex_lock(&hr->lock);
+    bool running = hr->running;
+    pthread_mutex_unlock(&hr->lock);
+    return running;
+}
+
+static void decode(HotReload *hr, uint64_t changed_ns)
+{
+    timing_sleep_ms(SETTLE_MS);
+    uint64_t decode_start = timing_now_ns();
+    Image image = LoadImage(hr->path);
+    if (!IsImageValid(image)) return;
+    ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    uint64_t decoded_ns = timing_now_ns();
+
+    pthread_mutex_lock(&hr->lock);
+    // the main thread hasn't taken the last one yet, the newer file wins
+    if (hr->ready) UnloadImage(hr->image);
+    else hr->changed_ns = changed_ns;
+    hr->image = image;
+    hr->decode_ns = decoded_ns - decode_start;
+    hr->ready = true;
+    pthread_mutex_unlock(&hr->lock);
+}
+
+#if defined(HOT_RELOAD_INOTIFY)
+// watches the directory, saving through a temp file and a rename replaces the inode
+static void *watch(void *arg)
+{
+    HotReload *hr = arg;
+    char dir[256];
+    const char *slash = strrchr(hr->path, '/');
+    const char *name = slash ? slash + 1 : hr->path;
+    if (slash) snprintf(dir, sizeof(dir), "%.*s", (int) (slash - hr->path), hr->path);
+    else snprintf(dir, sizeof(dir), ".");
+
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) return NULL;
+    if (inotify_add_watch(fd, dir, IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) < 0) {
+        close(fd);
+        return NULL;
+    }
+    char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    while (still_running(hr)) {
+        struct pollfd p = {fd, POLLIN, 0};
+        if (poll(&p, 1, POLL_MS) <= 0) continue;
+        uint64_t changed_ns = timing_now_ns();
+        bool changed = false;
+        ssize_t len;
+        while ((len = read(fd, buffer, sizeof(buffer))) > 0) {
+            for (char *at = buffer; at < buffer + len;) {
+                const struct inotify_event *e = (const struct inotify_event *) at;
+                if (e->len && strcmp(e->name, name) == 0) changed = true;
+                at += sizeof(*e) + e->len;
+            }
+        }
+        if (changed) decode(hr, changed_ns);
+    }
+    close(fd);
+    return NULL;
+}
+#else
+static bool modified_time(const char *path, time_t *mtime)
+{
+    struct stat st;
+    if (stat(path, &st) != 0) return false;
+    *mtime = st.st_mtime;
+    return true;
+}
+
+// no inotify here, compare modification times instead
+static void *watch(void *arg)
+{
+    HotReload *hr = arg;
+    time_t last = 0;
+    modified_time(hr->path, &last);
+    while (still_running(hr)) {
+        timing_sleep_ms(POLL_MS);
+        time_t now;
+        if (!modified_time(hr->path, &now) || now == last) continue;
+        last = now;
+        decode(hr, timing_now_ns());
+    }
+    return NULL;
+}
+#endif
+
+bool hot_reload_start(HotReload *hr, const char *path)
+{
+    *hr = (HotReload) {0};
+    snprintf(hr->path, sizeof(hr->path), "%s", path);
+    struct stat st;
+    if (stat(hr->path, &st) != 0) return false;
+    if (pthread_mutex_init(&hr->lock, NULL) != 0) return false;
+    hr->running = true;
+    if (pthread_create(&hr->thread, NULL, watch, hr) != 0) {
+        pthread_mutex_destroy(&hr->lock);
+        return false;
+    }
+    hr->started = true;
+    return true;
+}
+
+// never blocks: if the watcher holds the lock the image waits for the next frame
+bool hot_reload_take(HotReload *hr, Image *image)
+{
+    if (!hr->started || pthread_mutex_trylock(&hr->lock) != 0) return false;
+    bool ready = hr->ready;
+    if (ready) {
+        *image = hr->image;
+        hr->taken_changed_ns = hr->changed_ns;
+        hr->taken_decode_ns = hr->decode_ns;
+        hr->ready = false;
+    }
+    pthread_mutex_unlock(&hr->lock);
+    return ready;
+}
+
+void hot_reload_swapped(HotReload *hr)
+{
+    hr->reloads++;
+    hr->latency_ms = (float) ((double) (timing_now_ns() - hr->taken_changed_ns) * 1e-6);
+    hr->decode_ms = (float) ((double) hr->taken_decode_ns * 1e-6);
+}
+
+void hot_reload_stop(HotReload *hr)
+{
+    if (!hr->started) return;
+    pthread_mutex_lock(&hr->lock);
+    hr->running = false;
+    pthread_mutex_unlock(&hr->lock);
+    pthread_join(hr->thread, NULL);
+    if (hr->ready) UnloadImage(hr->image);
+    pthread_mutex_destroy(&hr->lock);
+    hr->started = false;
+}
@@ -0,0 +1,37 @@
+#ifndef HOTRELOAD_H
+#define HOTRELOAD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "raylib.h"
+
+// watches one image file from a background thread and decodes it there when it
+// changes; the main thread picks the decoded image up at a frame boundary
+// without ever waiting on the watcher, disk or the png decoder
+
+typedef struct hot_reload {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    char path[256];
+    bool started;
+    // shared, under lock
+    bool running;
+    bool ready;
+    Image image;
+    uint64_t changed_ns;        // when the watcher first saw the change
+    uint64_t decode_ns;
+    // main thread only
+    uint64_t taken_changed_ns;
+    uint64_t taken_decode_ns;
+    int reloads;
+    float latency_ms;           // file change to texture swapped
+    float decode_ms;
+} HotReload;
+
+bool hot_reload_start(HotReload *hr, const char *path);
+bool hot_reload_take(HotReload *hr, Image *image);
+void hot_reload_swapped(HotReload *hr);
+void hot_reload_stop(HotReload *hr);
+
+#endif
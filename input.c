@@ -0,0 +1,114 @@
+#include <stdlib.h>
+#include <string.h>
+#include "input.h"
+#include "replay.h"
+
+void input_queue_init(InputQueue *q)
+{
+    memset(q, 0, sizeof(*q));
+}
+
+// the release on tail orders the event before the consumer can see it
+bool input_push(InputQueue *q, InputEvent e)
+{
+    uint32_t tail = q->tail;
+    if (tail - __atomic_load_n(&q->head, __ATOMIC_ACQUIRE) == INPUT_QUEUE_SIZE) return false;
+    q->events[tail & (INPUT_QUEUE_SIZE - 1)] = e;
+    __atomic_store_n(&q->tail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+bool input_peek(InputQueue *q, InputEvent *e)
+{
+    uint32_t head = q->head;
+    if (head == __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE)) return false;
+    *e = q->events[head & (INPUT_QUEUE_SIZE - 1)];
+    return true;
+}
+
+bool input_pop(InputQueue *q, InputEvent *e)
+{
+    if (!input_peek(q, e)) return false;
+    __atomic_store_n(&q->head, q->head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+// one event per key that changed since the last sample, plus one for a space press.
+// a change that doesn't fit stays unsent and goes out with the next sample, a press
+// that doesn't fit is counted and the latch takes it once the queue has drained
+void input_sample(InputQueue *q, SimInput input, uint64_t t_ns)
+{
+    bool space = input.space_pressed;
+    input.space_pressed = false;
+    uint8_t bits = pack_input(input);
+    uint8_t changed = bits ^ q->sent;
+    for (int i = 0; i < 8; i++) {
+        uint8_t bit = (uint8_t) (1u << i);
+        if (!(changed & bit)) continue;
+        if (input_push(q, (InputEvent) {t_ns, 0, bit, (bits & bit) != 0})) q->sent ^= bit;
+    }
+    if (space && !input_push(q, (InputEvent) {t_ns, 0, INPUT_SPACE, true})) {
+        __atomic_fetch_add(&q->overflow, 1, __ATOMIC_RELAXED);
+    }
+}
+
+// drains whatever has arrived, stopping short of a second space press so each tick
+// takes at most one and the rest wait their turn. presses are queued back on applied
+// stamped with tick, when there is an applied queue; overflowed ones went unstamped
+// and aren't timed
+SimInput input_latch(InputLatch *latch, InputQueue *q, uint64_t tick, InputQueue *applied)
+{
+    bool pressed = false;
+    InputEvent e;
+    while (input_peek(q, &e)) {
+        if (e.bit == INPUT_SPACE) {
+            if (pressed) break;
+            pressed = true;
+        } else if (e.down) {
+            latch->held |= e.bit;
+        } else {
+            latch->held &= (uint8_t) ~e.bit;
+        }
+        input_pop(q, &e);
+        if (applied && e.bit == INPUT_SPACE) {
+            e.tick = tick;
+            input_push(applied, e);
+        }
+    }
+    // only this thread takes from the count, one seen here is still there for the sub
+    if (!pressed && !input_peek(q, &e) && __atomic_load_n(&q->overflow, __ATOMIC_RELAXED) > 0) {
+        __atomic_fetch_sub(&q->overflow, 1, __ATOMIC_RELAXED);
+        pressed = true;
+    }
+    SimInput input = unpack_input(latch->held);
+    input.space_pressed = pressed;
+    return input;
+}
+
+void input_latency_push(InputLatency *l, uint64_t ns)
+{
+    l->ms[l->next] = (float) (ns * 1e-6);
+    l->next = (l->next + 1) % INPUT_LATENCY_HISTORY;
+    if (l->count < INPUT_LATENCY_HISTORY) l->count++;
+}
+
+static int compare_float(const void *a, const void *b)
+{
+    float x = *(const float *) a;
+    float y = *(const float *) b;
+    return (x > y) - (x < y);
+}
+
+// over the last INPUT_LATENCY_HISTORY presses, all zero before the first
+void input_latency_stats(const InputLatency *l, float *p50, float *p95, float *p99)
+{
+    float sorted[INPUT_LATENCY_HISTORY];
+    int n = l->count;
+    *p50 = *p95 = *p99 = 0.0f;
+    if (n == 0) return;
+    memcpy(sorted, l->ms, n * sizeof(float));
+    qsort(sorted, n, sizeof(float), compare_float);
+    *p50 = sorted[(n - 1) * 50 / 100];
+    *p95 = sorted[(n - 1) * 95 / 100];
+    *p99 = sorted[(n - 1) * 99 / 100];
+}
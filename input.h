@@ -0,0 +1,56 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sim.h"
+
+// key events stamped when they're polled and queued from the render thread to
+// the sim thread, which folds them into a SimInput right before each tick instead
+// of taking whatever the last frame saw. the sim thread queues every press it
+// applied back with the tick that took it, and once a frame showing that tick is
+// presented the render thread has a press to present latency
+// raylib doesn't pass on the OS event time, so the stamp is the poll that saw it
+
+#define INPUT_QUEUE_SIZE 256        // power of two
+#define INPUT_LATENCY_HISTORY 256
+
+typedef struct input_event {
+    uint64_t t_ns;
+    uint64_t tick;                  // on the way back, the tick the event went into
+    uint8_t bit;                    // one InputBits flag
+    bool down;
+} InputEvent;
+
+// one producer, one consumer
+typedef struct input_queue {
+    InputEvent events[INPUT_QUEUE_SIZE];
+    uint32_t head;                  // advanced by the consumer
+    uint32_t tail;                  // advanced by the producer
+    uint8_t sent;                   // producer only, InputBits as last queued
+    uint32_t overflow;              // shared, space presses that found the queue full
+} InputQueue;
+
+// the consumer's view of the keys, built up one event at a time
+typedef struct input_latch {
+    uint8_t held;                   // InputBits without space, presses are events
+} InputLatch;
+
+typedef struct input_latency {
+    float ms[INPUT_LATENCY_HISTORY];
+    int next;
+    int count;
+} InputLatency;
+
+void input_queue_init(InputQueue *q);
+bool input_push(InputQueue *q, InputEvent e);
+bool input_pop(InputQueue *q, InputEvent *e);
+bool input_peek(InputQueue *q, InputEvent *e);
+
+void input_sample(InputQueue *q, SimInput input, uint64_t t_ns);
+SimInput input_latch(InputLatch *latch, InputQueue *q, uint64_t tick, InputQueue *applied);
+
+void input_latency_push(InputLatency *l, uint64_t ns);
+void input_latency_stats(const InputLatency *l, float *p50, float *p95, float *p99);
+
+#endif
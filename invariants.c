@@ -0,0 +1,122 @@
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include "invariants.h"
+
+static bool fail(char *why, size_t len, const char *fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(why, len, fmt, args);
+    va_end(args);
+    return false;
+}
+
+static bool check_pool(const EntityPool *p, int capacity, const char *name, char *why, size_t len)
+{
+    if (p->capacity != capacity) return fail(why, len, "%s capacity %d, expected %d", name, p->capacity, capacity);
+    if (p->count < 0 || p->count > p->capacity) return fail(why, len, "%s count %d out of range", name, p->count);
+    for (int i = 0; i < p->count; i++) {
+        if (pool_index(p, p->handles[i]) != i) return fail(why, len, "%s dense %d holds stale handle %x", name, i, p->handles[i]);
+    }
+    for (int i = p->count; i < p->capacity; i++) {
+        if (p->handles[i] != POOL_NO_HANDLE) return fail(why, len, "%s dense %d past count still holds %x", name, i, p->handles[i]);
+    }
+    // every slot is either live or on the free list, never both
+    int free_slots = 0;
+    for (int slot = p->free_head; slot >= 0; slot = p->next_free[slot]) {
+        if (slot >= p->capacity || free_slots >= p->capacity) return fail(why, len, "%s free list is corrupt", name);
+        if (p->indices[slot] != -1) return fail(why, len, "%s free slot %d is still live", name, slot);
+        free_slots++;
+    }
+    if (free_slots != p->capacity - p->count) {
+        return fail(why, len, "%s has %d live and %d free of %d", name, p->count, free_slots, p->capacity);
+    }
+    return true;
+}
+
+static bool check_order(const PoolOrder *o, const EntityPool *p, const float *key, const char *name, char *why, size_t len)
+{
+    if (o->count != p->count) return fail(why, len, "%s order has %d of %d", name, o->count, p->count);
+    bool seen[POOL_MAX_CAPACITY] = {false};
+    float last = -INFINITY;
+    for (int i = 0; i < o->count; i++) {
+        int n = pool_index(p, o->handles[i]);
+        if (n < 0) return fail(why, len, "%s order %d holds dead handle %x", name, i, o->handles[i]);
+        int slot = o->handles[i] & POOL_SLOT_MASK;
+        if (seen[slot]) return fail(why, len, "%s order holds %x twice", name, o->handles[i]);
+        seen[slot] = true;
+        if (key[n] < last) return fail(why, len, "%s order out of order at %d", name, i);
+        last = key[n];
+    }
+    return true;
+}
+
+static bool check_finite(const float *v, int n, const char *name, char *why, size_t len)
+{
+    for (int i = 0; i < n; i++) {
+        if (!isfinite(v[i])) return fail(why, len, "%s %d is not finite", name, i);
+    }
+    return true;
+}
+
+bool world_invariants(const World *w, char *why, size_t len)
+{
+    const Crates *crates = &w->crates;
+    const PlayerCrate *boxes = &w->boxes;
+    const Bullets *bullets = &w->bullets;
+    const Cannons *cannons = &w->cannons;
+
+    const SimParams *limits = &w->params;
+    if (!check_pool(&crates->pool, limits->crates, "crates", why, len)) return false;
+    if (!check_pool(&boxes->pool, limits->boxes, "boxes", why, len)) return false;
+    if (!check_pool(&bullets->pool, limits->cannons, "bullets", why, len)) return false;
+    if (!check_pool(&w->planks.pool, limits->planks, "planks", why, len)) return false;
+    if (!check_order(&crates->by_y, &crates->pool, crates->y, "crates", why, len)) return false;
+    if (!check_order(&boxes->by_y, &boxes->pool, boxes->y, "boxes", why, len)) return false;
+
+    if (crates->selected != POOL_NO_HANDLE && pool_index(&crates->pool, crates->selected) < 0) {
+        return fail(why, len, "selected crate %x is dead", crates->selected);
+    }
+
+    for (int i = 0; i < bullets->pool.count; i++) {
+        int owner = bullets->owner[i];
+        if (owner < 0 || owner >= limits->cannons) return fail(why, len, "bullet %d has owner %d", i, owner);
+    }
+    for (int i = 0; i < limits->cannons; i++) {
+        int handle = cannons->bullet[i].bullet;
+        if (handle == POOL_NO_HANDLE) continue;
+        int n = pool_index(&bullets->pool, handle);
+        if (n < 0) return fail(why, len, "cannon %d holds dead bullet %x", i, handle);
+        if (bullets->owner[n] != i) return fail(why, len, "cannon %d holds bullet %x owned by %d", i, handle, bullets->owner[n]);
+    }
+
+    if (!check_finite(crates->x, crates->pool.count, "crate x", why, len)) return false;
+    if (!check_finite(crates->y, crates->pool.count, "crate y", why, len)) return false;
+    if (!check_finite(boxes->x, boxes->pool.count, "box x", why, len)) return false;
+    if (!check_finite(boxes->y, boxes->pool.count, "box y", why, len)) return false;
+    if (!check_finite(bullets->x, bullets->pool.count, "bullet x", why, len)) return false;
+    if (!check_finite(bullets->y, bullets->pool.count, "bullet y", why, len)) return false;
+    if (!check_finite(w->planks.x, w->planks.pool.count, "plank x", why, len)) return false;
+    if (!check_finite(w->planks.y, w->planks.pool.count, "plank y", why, len)) return false;
+    if (!isfinite(w->player.dest_rect.x) || !isfinite(w->player.dest_rect.y)) return fail(why, len, "player position is not finite");
+    if (w->player.inventory < 0) return fail(why, len, "inventory %d", w->player.inventory);
+    if (w->scroll < 0.0f || w->scroll >= SCROLL_REBASE) return fail(why, len, "scroll %f past the rebase", w->scroll);
+
+    // the grid is kept up to date piecemeal through the tick, it has to match one built from scratch
+    static __thread SpatialGrid rebuilt;
+    sim_build_grid(w, &rebuilt);
+    const SpatialGrid *grid = sim_grid();
+    for (int layer = 0; layer < GRID_LAYERS; layer++) {
+        for (int c = 0; c < GRID_CELLS; c++) {
+            for (int k = 0; k < GRID_WORDS; k++) {
+                uint64_t have = grid->cells[layer][c].bits[k];
+                uint64_t want = rebuilt.cells[layer][c].bits[k];
+                if (have == want) continue;
+                return fail(why, len, "grid layer %d cell %d,%d word %d is %llx, a rebuild gives %llx", layer, c % GRID_COLS, c / GRID_COLS,
+                    k, (unsigned long long) have, (unsigned long long) want);
+            }
+        }
+    }
+    return true;
+}
@@ -0,0 +1,15 @@
+#ifndef INVARIANTS_H
+#define INVARIANTS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "sim.h"
+
+// bookkeeping the sim has to keep in step by hand: pool free lists and dense
+// indices, y orders, the incremental grid against a rebuild, handles held by
+// cannons and the crate selection. false with a one line reason in why on the first break.
+// the grid is the calling thread's, so check a world on the thread that just stepped it
+
+bool world_invariants(const World *w, char *why, size_t len);
+
+#endif
@@ -0,0 +1,164 @@
+#include "pipeline.h"
+#include "profiler.h"
+#include "timing.h"
+
+#define SNAPSHOT_FRESH 4
+
+static void snapshot_init(SnapshotBuffer *b)
+{
+    b->back = 0;
+    b->middle = 1;
+    b->front = 2;
+}
+
+// the release on the swap orders the slot's contents before the reader can see it
+static void snapshot_publish(SnapshotBuffer *b)
+{
+    int old = __atomic_exchange_n(&b->middle, b->back | SNAPSHOT_FRESH, __ATOMIC_ACQ_REL);
+    b->back = old & ~SNAPSHOT_FRESH;
+}
+
+static const Snapshot *snapshot_latest(SnapshotBuffer *b)
+{
+    if (__atomic_load_n(&b->middle, __ATOMIC_ACQUIRE) & SNAPSHOT_FRESH) {
+        int old = __atomic_exchange_n(&b->middle, b->front, __ATOMIC_ACQ_REL);
+        b->front = old & ~SNAPSHOT_FRESH;
+    }
+    return &b->slots[b->front];
+}
+
+static bool still_running(SimThread *st)
+{
+    return __atomic_load_n(&st->running, __ATOMIC_ACQUIRE);
+}
+
+static void *sim_loop(void *arg)
+{
+    SimThread *st = arg;
+    profiler_thread(1);
+    uint64_t tick_len = (uint64_t) (SIM_DT / st->speed * 1e9);
+    uint64_t next_tick = timing_now_ns() + tick_len;
+    uint64_t ticks = 0;
+    bool replay_done = false;
+    while (still_running(st)) {
+        uint64_t now = timing_now_ns();
+        if (now < next_tick || replay_done) {
+            if (next_tick - now > 1000000 || replay_done) timing_sleep_ms(1);
+            continue;
+        }
+        // too far behind to catch up, drop the backlog instead of spiralling
+        if (now - next_tick > SIM_MAX_SUBSTEPS * tick_len) next_tick = now;
+
+        Snapshot *back = &st->snapshots.slots[st->snapshots.back];
+        back->prev = st->world;
+        bool rewinding = st->can_rewind && __atomic_load_n(&st->rewinding, __ATOMIC_RELAXED);
+
+        // keys are folded in here, right before the step, rather than when the render
+        // thread recorded its frame; only presses that reach the world are timed
+        bool from_keys = !rewinding && !st->reader && !st->bot;
+        SimInput input = input_latch(&st->latch, &st->events, ticks + 1, from_keys ? &st->applied : NULL);
+        if (rewinding) {
+            // one tick back per tick, holding on the oldest once the history runs out;
+            // presses made while scrubbing are dropped
+            rewind_pop(&st->rewind, &st->world);
+            sim_sync_grid(&st->world);
+            input = (SimInput) {.debug = st->world.debug_mode};
+        } else if (st->reader) {
+            if (!replay_reader_next(st->reader, &input)) replay_done = true;
+        } else {
+            if (st->bot) {
+                bool debug = input.debug;
+                input = bot_input(st->bot, &st->world);
+                input.debug = debug;
+            }
+            if (st->writer) replay_writer_push(st->writer, input);
+        }
+
+        if (!replay_done && !rewinding) {
+            uint64_t start = timing_now_ns();
+            sim_step(&st->world, input, SIM_DT);
+            if (st->can_rewind) rewind_push(&st->rewind, &st->world);
+            ticks++;
+            profiler_record(ZONE_SIM_TICK, start, timing_now_ns());
+        }
+        back->world = st->world;
+        back->tick_ns = next_tick;
+        back->tick_len_ns = tick_len;
+        back->ticks = ticks;
+        back->rewind_seconds = rewind_seconds(&st->rewind);
+        back->debug = input.debug;
+        back->replay_done = replay_done;
+        back->rewinding = rewinding;
+        snapshot_publish(&st->snapshots);
+        next_tick += tick_len;
+    }
+    return NULL;
+}
+
+// all three slots start as the initial world so the first frame has something to draw
+bool sim_thread_start(SimThread *st, uint64_t seed, ReplayReader *reader, ReplayWriter *writer, Bot *bot, float speed)
+{
+    sim_init(&st->world, seed);
+    snapshot_init(&st->snapshots);
+    for (int i = 0; i < 3; i++) {
+        Snapshot *s = &st->snapshots.slots[i];
+        s->prev = st->world;
+        s->world = st->world;
+        s->tick_ns = timing_now_ns();
+        s->tick_len_ns = (uint64_t) (SIM_DT / speed * 1e9);
+        s->ticks = 0;
+        s->rewind_seconds = 0.0f;
+        s->debug = false;
+        s->replay_done = false;
+        s->rewinding = false;
+    }
+    rewind_reset(&st->rewind, &st->world);
+    st->can_rewind = !reader && !(writer && writer->file);
+    st->reader = reader;
+    st->writer = writer;
+    st->bot = reader ? NULL : bot;
+    st->speed = speed;
+    st->latch = (InputLatch) {0};
+    input_queue_init(&st->events);
+    input_queue_init(&st->applied);
+    st->rewinding = 0;
+    __atomic_store_n(&st->running, 1, __ATOMIC_RELEASE);
+    if (pthread_create(&st->thread, NULL, sim_loop, st) != 0) {
+        st->running = 0;
+        return false;
+    }
+    return true;
+}
+
+void sim_thread_input(SimThread *st, SimInput input, uint64_t polled_ns)
+{
+    input_sample(&st->events, input, polled_ns);
+}
+
+// shown has just gone out, every press applied by the tick it shows or earlier is
+// on screen now
+void sim_thread_presented(SimThread *st, const Snapshot *shown, uint64_t present_ns, InputLatency *latency)
+{
+    InputEvent e;
+    while (input_peek(&st->applied, &e) && e.tick <= shown->ticks) {
+        input_pop(&st->applied, &e);
+        input_latency_push(latency, (present_ns > e.t_ns) ? present_ns - e.t_ns : 0);
+    }
+}
+
+void sim_thread_rewind(SimThread *st, bool rewinding)
+{
+    __atomic_store_n(&st->rewinding, rewinding, __ATOMIC_RELAXED);
+}
+
+// the newest finished tick, stays valid until the next call
+const Snapshot *sim_thread_latest(SimThread *st)
+{
+    return snapshot_latest(&st->snapshots);
+}
+
+void sim_thread_stop(SimThread *st)
+{
+    if (!__atomic_exchange_n(&st->running, 0, __ATOMIC_ACQ_REL)) return;
+    pthread_join(st->thread, NULL);
+}
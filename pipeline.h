@@ -0,0 +1,63 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "sim.h"
+#include "replay.h"
+#include "rewind.h"
+#include "bot.h"
+#include "input.h"
+
+// two stage pipeline: a sim thread steps the world on its own clock and hands
+// finished ticks to the render thread through a triple buffer, so neither side
+// waits on the other and a frame costs the slower stage instead of both
+
+typedef struct snapshot {
+    World prev;
+    World world;
+    uint64_t tick_ns;           // when world became current, interpolation runs from here
+    uint64_t tick_len_ns;       // scaled by replay speed
+    uint64_t ticks;             // ticks stepped so far, presses come back stamped with these
+    float rewind_seconds;       // history left to scrub back through
+    bool debug;
+    bool replay_done;
+    bool rewinding;
+} Snapshot;
+
+// three slots: the writer fills back, the reader holds front, and middle is
+// swapped atomically between them with a fresh bit so a publish is never lost
+typedef struct snapshot_buffer {
+    Snapshot slots[3];
+    int back;                   // writer only
+    int front;                  // reader only
+    int middle;                 // shared, slot index | SNAPSHOT_FRESH
+} SnapshotBuffer;
+
+typedef struct sim_thread {
+    pthread_t thread;
+    SnapshotBuffer snapshots;
+    World world;
+    RewindBuffer rewind;
+    bool can_rewind;            // a rewind would throw a recording or replay out of step
+    ReplayReader *reader;
+    ReplayWriter *writer;
+    Bot *bot;                   // plays instead of the keyboard when set, searching on the sim thread
+    float speed;
+    InputLatch latch;           // sim thread only
+    InputQueue events;          // render thread to sim thread
+    InputQueue applied;         // sim thread to render thread, space presses that made it into a tick
+    // shared, written by the render thread with __atomic builtins
+    uint32_t rewinding;
+    uint32_t running;
+} SimThread;
+
+bool sim_thread_start(SimThread *st, uint64_t seed, ReplayReader *reader, ReplayWriter *writer, Bot *bot, float speed);
+void sim_thread_input(SimThread *st, SimInput input, uint64_t polled_ns);
+void sim_thread_presented(SimThread *st, const Snapshot *shown, uint64_t present_ns, InputLatency *latency);
+void sim_thread_rewind(SimThread *st, bool rewinding);
+const Snapshot *sim_thread_latest(SimThread *st);
+void sim_thread_stop(SimThread *st);
+
+#endif
@@ -0,0 +1,85 @@
+#include <string.h>
+#include "pool.h"
+
+void pool_init(EntityPool *p, int capacity)
+{
+    if (capacity > POOL_MAX_CAPACITY) capacity = POOL_MAX_CAPACITY;
+    p->capacity = capacity;
+    p->count = 0;
+    p->free_head = (capacity > 0) ? 0 : -1;
+    for (int i = 0; i < capacity; i++) {
+        p->handles[i] = POOL_NO_HANDLE;
+        p->indices[i] = -1;
+        p->next_free[i] = (i + 1 < capacity) ? i + 1 : -1;
+        p->generation[i] = 0;
+    }
+}
+
+// returns the dense index of the new entity, or -1 when the pool is full
+int pool_spawn(EntityPool *p)
+{
+    int slot = p->free_head;
+    if (slot < 0) return -1;
+    p->free_head = p->next_free[slot];
+
+    p->generation[slot] = (p->generation[slot] + 1) & 0x7FFF;
+    int index = p->count++;
+    p->indices[slot] = index;
+    p->handles[index] = (p->generation[slot] << POOL_SLOT_BITS) | slot;
+    return index;
+}
+
+// frees the entity at a dense index by moving the last one into its place
+// returns the dense index the caller must copy its arrays from (== index when nothing moved)
+int pool_despawn(EntityPool *p, int index)
+{
+    int last = --p->count;
+    int slot = p->handles[index] & POOL_SLOT_MASK;
+    p->indices[slot] = -1;
+    p->next_free[slot] = p->free_head;
+    p->free_head = slot;
+
+    if (index != last) {
+        int moved = p->handles[last];
+        p->handles[index] = moved;
+        p->indices[moved & POOL_SLOT_MASK] = index;
+    }
+    p->handles[last] = POOL_NO_HANDLE;
+    return last;
+}
+
+// dense index of a live handle, -1 when it is dead or stale
+int pool_index(const EntityPool *p, int handle)
+{
+    if (handle < 0) return -1;
+    int slot = handle & POOL_SLOT_MASK;
+    if (slot >= p->capacity) return -1;
+    if (p->generation[slot] != (handle >> POOL_SLOT_BITS)) return -1;
+    return p->indices[slot];
+}
+
+// key is indexed by dense index and must already hold the new entity's value;
+// equal keys keep insertion order
+void pool_order_insert(PoolOrder *o, const EntityPool *p, const float *key, int handle)
+{
+    float k = key[pool_index(p, handle)];
+    int lo = 0, hi = o->count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (key[pool_index(p, o->handles[mid])] <= k) lo = mid + 1;
+        else hi = mid;
+    }
+    memmove(&o->handles[lo + 1], &o->handles[lo], (o->count - lo) * sizeof(int));
+    o->handles[lo] = handle;
+    o->count++;
+}
+
+void pool_order_remove(PoolOrder *o, int handle)
+{
+    for (int i = o->count - 1; i >= 0; i--) {
+        if (o->handles[i] != handle) continue;
+        memmove(&o->handles[i], &o->handles[i + 1], (o->count - i - 1) * sizeof(int));
+        o->count--;
+        return;
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <stdbool.h>
+
+// sparse set bookkeeping for structure-of-arrays entity storage
+// live entities occupy dense indices [0, count) so loops only touch live data;
+// handles stay valid across the swap-remove and carry a generation so a
+// recycled slot never answers for a dead entity
+
+#ifndef POOL_MAX_CAPACITY
+#define POOL_MAX_CAPACITY 64
+#endif
+#define POOL_SLOT_BITS 16
+#define POOL_SLOT_MASK ((1 << POOL_SLOT_BITS) - 1)
+#define POOL_NO_HANDLE -1
+
+typedef struct entity_pool {
+    int capacity;
+    int count;
+    int free_head;
+    int handles[POOL_MAX_CAPACITY];     // dense index -> handle
+    int indices[POOL_MAX_CAPACITY];     // slot -> dense index, -1 when free
+    int next_free[POOL_MAX_CAPACITY];
+    int generation[POOL_MAX_CAPACITY];
+} EntityPool;
+
+// handles sorted by a per entity key, smallest first, for range queries
+// that stop at the first miss instead of visiting every entity
+typedef struct pool_order {
+    int count;
+    int handles[POOL_MAX_CAPACITY];
+} PoolOrder;
+
+void pool_init(EntityPool *p, int capacity);
+int pool_spawn(EntityPool *p);
+int pool_despawn(EntityPool *p, int index);
+int pool_index(const EntityPool *p, int handle);
+void pool_order_insert(PoolOrder *o, const EntityPool *p, const float *key, int handle);
+void pool_order_remove(PoolOrder *o, int handle);
+
+static inline bool pool_full(const EntityPool *p)
+{
+    return p->count >= p->capacity;
+}
+
+#endif
@@ -0,0 +1,171 @@
+#include <stdlib.h>
+#include "profiler.h"
+
+// single producer rings: each thread owns the slots of its ring, readers copy out
+// whatever is between (head - RING_SIZE, head] and accept that the oldest may be torn
+static ProfileSample rings[PROFILER_THREADS][PROFILER_RING_SIZE];
+static uint64_t ring_heads[PROFILER_THREADS];
+static __thread uint32_t thread_id = PROFILER_NO_THREAD;
+
+static const char *zone_names[ZONE_COUNT] = {
+    "frame",
+    "sim_tick",
+    "update_player",
+    "update_cannons",
+    "collide_detect",
+    "collide_resolve",
+    "update_crates",
+    "update_boxes",
+    "update_planks",
+    "draw_watertiles",
+    "draw_scrolling_plank",
+    "draw_cannons",
+    "draw_bullets",
+    "draw_crates",
+    "draw_boxes",
+    "draw_planks",
+    "draw_player",
+    "draw_score",
+    "draw_overlay",
+    "draw_submit",
+    "present",
+};
+
+// call once at the top of each thread that records, before its first sample;
+// threads that never call it, like task pool workers, record nothing
+void profiler_thread(uint32_t thread)
+{
+    thread_id = (thread < PROFILER_THREADS) ? thread : PROFILER_NO_THREAD;
+}
+
+void profiler_record(ProfileZone zone, uint64_t start_ns, uint64_t end_ns)
+{
+    if (thread_id == PROFILER_NO_THREAD) return;
+    uint64_t head = __atomic_load_n(&ring_heads[thread_id], __ATOMIC_RELAXED);
+    ProfileSample *s = &rings[thread_id][head & (PROFILER_RING_SIZE - 1)];
+    s->start_ns = start_ns;
+    s->duration_ns = end_ns - start_ns;
+    s->zone = (uint32_t) zone;
+    s->thread = thread_id;
+    __atomic_store_n(&ring_heads[thread_id], head + 1, __ATOMIC_RELEASE);
+}
+
+const char *profiler_zone_name(ProfileZone zone)
+{
+    if ((unsigned) zone >= ZONE_COUNT) return "unknown";
+    return zone_names[zone];
+}
+
+// newest first walk over the samples still in the ring
+static uint64_t ring_oldest(uint64_t head)
+{
+    return (head > PROFILER_RING_SIZE) ? head - PROFILER_RING_SIZE : 0;
+}
+
+// samples land when their zone closes, so the last one written ends last
+static uint64_t ring_newest_end(const uint64_t heads[PROFILER_THREADS])
+{
+    uint64_t newest = 0;
+    for (int t = 0; t < PROFILER_THREADS; t++) {
+        if (heads[t] == 0) continue;
+        const ProfileSample *s = &rings[t][(heads[t] - 1) & (PROFILER_RING_SIZE - 1)];
+        if (s->start_ns + s->duration_ns > newest) newest = s->start_ns + s->duration_ns;
+    }
+    return newest;
+}
+
+static void load_heads(uint64_t heads[PROFILER_THREADS])
+{
+    for (int t = 0; t < PROFILER_THREADS; t++) heads[t] = __atomic_load_n(&ring_heads[t], __ATOMIC_ACQUIRE);
+}
+
+// frames are only ever recorded by thread 0
+int profiler_frame_history(float *frame_ms, int max_frames)
+{
+    uint64_t head = __atomic_load_n(&ring_heads[0], __ATOMIC_ACQUIRE);
+    uint64_t oldest = ring_oldest(head);
+    int n = 0;
+    for (uint64_t i = head; i > oldest && n < max_frames; i--) {
+        const ProfileSample *s = &rings[0][(i - 1) & (PROFILER_RING_SIZE - 1)];
+        if (s->zone != ZONE_FRAME) continue;
+        frame_ms[n++] = (float) (s->duration_ns * 1e-6);
+    }
+    // oldest on the left
+    for (int i = 0; i < n / 2; i++) {
+        float tmp = frame_ms[i];
+        frame_ms[i] = frame_ms[n - 1 - i];
+        frame_ms[n - 1 - i] = tmp;
+    }
+    return n;
+}
+
+static int compare_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *) a;
+    uint64_t y = *(const uint64_t *) b;
+    return (x > y) - (x < y);
+}
+
+#define STATS_MAX_SAMPLES 1024
+
+void profiler_zone_stats(uint64_t window_ns, ZoneStats stats[ZONE_COUNT])
+{
+    static uint64_t durations[ZONE_COUNT][STATS_MAX_SAMPLES];
+    int counts[ZONE_COUNT] = {0};
+
+    uint64_t heads[PROFILER_THREADS];
+    load_heads(heads);
+    uint64_t newest_end = ring_newest_end(heads);
+    for (int t = 0; t < PROFILER_THREADS; t++) {
+        uint64_t oldest = ring_oldest(heads[t]);
+        for (uint64_t i = heads[t]; i > oldest; i--) {
+            const ProfileSample *s = &rings[t][(i - 1) & (PROFILER_RING_SIZE - 1)];
+            if (s->start_ns + window_ns < newest_end) break;
+            if (s->zone >= ZONE_COUNT || counts[s->zone] >= STATS_MAX_SAMPLES) continue;
+            durations[s->zone][counts[s->zone]++] = s->duration_ns;
+        }
+    }
+
+    for (int z = 0; z < ZONE_COUNT; z++) {
+        int n = counts[z];
+        stats[z] = (ZoneStats) {.count = n};
+        if (n == 0) continue;
+        qsort(durations[z], n, sizeof(uint64_t), compare_u64);
+        stats[z].p50_ns = durations[z][(n - 1) / 2];
+        stats[z].p99_ns = durations[z][((n - 1) * 99) / 100];
+    }
+}
+
+// chrome://tracing / perfetto "trace_event" format, complete events only
+bool profiler_dump_trace(const char *path, uint64_t window_ns)
+{
+    FILE *f = fopen(path, "w");
+    if (!f) return false;
+
+    uint64_t heads[PROFILER_THREADS];
+    load_heads(heads);
+    uint64_t newest_end = ring_newest_end(heads);
+
+    // each thread's window in order, the viewer sorts by timestamp anyway
+    fprintf(f, "{\"traceEvents\":[\n");
+    bool first_event = true;
+    for (int t = 0; t < PROFILER_THREADS; t++) {
+        uint64_t oldest = ring_oldest(heads[t]);
+        uint64_t first = heads[t];
+        while (first > oldest && rings[t][(first - 1) & (PROFILER_RING_SIZE - 1)].start_ns + window_ns >= newest_end) {
+            first--;
+        }
+        for (uint64_t i = first; i < heads[t]; i++) {
+            const ProfileSample *s = &rings[t][i & (PROFILER_RING_SIZE - 1)];
+            fprintf(f, "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+                first_event ? "" : ",\n",
+                profiler_zone_name((ProfileZone) s->zone),
+                (s->zone >= ZONE_SIM_TICK && s->zone <= ZONE_UPDATE_PLANKS) ? "sim" : "render",
+                s->start_ns * 1e-3, s->duration_ns * 1e-3, s->thread);
+            first_event = false;
+        }
+    }
+    fprintf(f, "\n],\"displayTimeUnit\":\"ms\"}\n");
+    fclose(f);
+    return true;
+}
@@ -0,0 +1,72 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "timing.h"
+
+// zone timers feeding lock-free ring buffers of samples, one per thread
+// build with -DENABLE_PROFILER, otherwise PROFILE_SCOPE compiles away
+
+typedef enum {
+    ZONE_FRAME = 0,
+    ZONE_SIM_TICK,
+    ZONE_UPDATE_PLAYER,
+    ZONE_UPDATE_CANNONS,
+    ZONE_COLLIDE_DETECT,
+    ZONE_COLLIDE_RESOLVE,
+    ZONE_UPDATE_CRATES,
+    ZONE_UPDATE_BOXES,
+    ZONE_UPDATE_PLANKS,
+    ZONE_DRAW_WATERTILES,
+    ZONE_DRAW_SCROLLING_PLANK,
+    ZONE_DRAW_CANNONS,
+    ZONE_DRAW_BULLETS,
+    ZONE_DRAW_CRATES,
+    ZONE_DRAW_BOXES,
+    ZONE_DRAW_PLANKS,
+    ZONE_DRAW_PLAYER,
+    ZONE_DRAW_SCORE,
+    ZONE_DRAW_OVERLAY,
+    ZONE_DRAW_SUBMIT,
+    ZONE_PRESENT,
+    ZONE_COUNT
+} ProfileZone;
+
+#define PROFILER_RING_SIZE (1 << 16)
+#define PROFILER_THREADS 2          // 0 renders and records frames, 1 runs the sim
+#define PROFILER_NO_THREAD 0xFFFFFFFFu
+#define PROFILER_HISTORY 240
+#define PROFILER_DUMP_SECONDS 5
+
+typedef struct profile_sample {
+    uint64_t start_ns;
+    uint64_t duration_ns;
+    uint32_t zone;
+    uint32_t thread;
+} ProfileSample;
+
+typedef struct zone_stats {
+    uint64_t p50_ns;
+    uint64_t p99_ns;
+    int count;
+} ZoneStats;
+
+// runs the statement that follows it and records how long it took
+#if defined(ENABLE_PROFILER)
+#define PROFILE_SCOPE(zone) \
+    for (uint64_t profile_start_ = timing_now_ns(), profile_once_ = 1; profile_once_; \
+         profile_once_ = 0, profiler_record((zone), profile_start_, timing_now_ns()))
+#else
+#define PROFILE_SCOPE(zone)
+#endif
+
+void profiler_thread(uint32_t thread);
+void profiler_record(ProfileZone zone, uint64_t start_ns, uint64_t end_ns);
+const char *profiler_zone_name(ProfileZone zone);
+int profiler_frame_history(float *frame_ms, int max_frames);
+void profiler_zone_stats(uint64_t window_ns, ZoneStats stats[ZONE_COUNT]);
+bool profiler_dump_trace(const char *path, uint64_t window_ns);
+
+#endif
@@ -0,0 +1,139 @@
+#include <stdlib.h>
+#include <string.h>
+#include "render.h"
+
+// key layout, high to low: layer 8 | texture 24 | primitive 4 | sequence 28
+#define KEY_SEQ_BITS 28
+#define KEY_PRIM_SHIFT KEY_SEQ_BITS
+#define KEY_TEXTURE_SHIFT (KEY_PRIM_SHIFT + 4)
+#define KEY_LAYER_SHIFT (KEY_TEXTURE_SHIFT + 24)
+#define KEY_SEQ_MASK ((1ull << KEY_SEQ_BITS) - 1)
+
+// raylib draws shapes as quads and thick lines as triangles, a switch between them flushes
+typedef enum {
+    PRIM_QUADS = 0,
+    PRIM_TRIANGLES
+} Primitive;
+
+static RenderCommand commands[RENDER_MAX_COMMANDS];
+static uint64_t keys[RENDER_MAX_COMMANDS];
+static int command_count;
+static char text_arena[RENDER_TEXT_BYTES];
+static int text_used;
+static RenderStats frame_stats;
+static RenderStats last_stats;
+
+void render_begin(void)
+{
+    command_count = 0;
+    text_used = 0;
+    frame_stats = (RenderStats) {0};
+}
+
+// shapes sort as texture 0, they all go through raylib's default white texture
+static RenderCommand *push(RenderLayer layer, unsigned int texture_id, Primitive prim)
+{
+    if (command_count >= RENDER_MAX_COMMANDS) {
+        frame_stats.dropped++;
+        return NULL;
+    }
+    int n = command_count++;
+    keys[n] = ((uint64_t) layer << KEY_LAYER_SHIFT) |
+              ((uint64_t) (texture_id & 0xFFFFFF) << KEY_TEXTURE_SHIFT) |
+              ((uint64_t) prim << KEY_PRIM_SHIFT) |
+              (uint64_t) n;
+    RenderCommand *c = &commands[n];
+    memset(c, 0, sizeof(*c));
+    return c;
+}
+
+void render_texture(RenderLayer layer, Texture2D texture, Rectangle source, Rectangle dest, Vector2 origin, Color tint)
+{
+    RenderCommand *c = push(layer, texture.id, PRIM_QUADS);
+    if (!c) return;
+    c->kind = CMD_TEXTURE;
+    c->texture = texture;
+    c->source = source;
+    c->dest = dest;
+    c->origin = origin;
+    c->color = tint;
+}
+
+void render_rect(RenderLayer layer, Rectangle rec, Color color)
+{
+    RenderCommand *c = push(layer, 0, PRIM_QUADS);
+    if (!c) return;
+    c->kind = CMD_RECT;
+    c->dest = rec;
+    c->color = color;
+}
+
+void render_rect_lines(RenderLayer layer, Rectangle rec, float thick, Color color)
+{
+    RenderCommand *c = push(layer, 0, PRIM_QUADS);
+    if (!c) return;
+    c->kind = CMD_RECT_LINES;
+    c->dest = rec;
+    c->thick = thick;
+    c->color = color;
+}
+
+void render_line(RenderLayer layer, Vector2 from, Vector2 to, float thick, Color color)
+{
+    RenderCommand *c = push(layer, 0, PRIM_TRIANGLES);
+    if (!c) return;
+    c->kind = CMD_LINE;
+    c->dest = (Rectangle) {from.x, from.y, to.x, to.y};
+    c->thick = thick;
+    c->color = color;
+}
+
+// the text is copied, TextFormat buffers get reused long before the flush
+void render_text(RenderLayer layer, const char *text, int x, int y, int size, Color color)
+{
+    int len = (int) strlen(text) + 1;
+    if (text_used + len > RENDER_TEXT_BYTES) {
+        frame_stats.dropped++;
+        return;
+    }
+    RenderCommand *c = push(layer, render_font_texture(), PRIM_QUADS);
+    if (!c) return;
+    memcpy(&text_arena[text_used], text, len);
+    c->kind = CMD_TEXT;
+    c->text = text_used;
+    c->dest = (Rectangle) {(float) x, (float) y, 0, 0};
+    c->thick = (float) size;
+    c->color = color;
+    text_used += len;
+}
+
+static int compare_key(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *) a;
+    uint64_t y = *(const uint64_t *) b;
+    return (x > y) - (x < y);
+}
+
+// sequence numbers are unique, so the sort is stable without a stable sort
+void render_flush(void)
+{
+    qsort(keys, command_count, sizeof(keys[0]), compare_key);
+
+    uint64_t batch_mask = ~((1ull << KEY_PRIM_SHIFT) - 1) & ~(0xFFull << KEY_LAYER_SHIFT);
+    uint64_t batch = ~0ull;
+    for (int i = 0; i < command_count; i++) {
+        if ((keys[i] & batch_mask) != batch) {
+            batch = keys[i] & batch_mask;
+            frame_stats.batches++;
+        }
+        const RenderCommand *c = &commands[keys[i] & KEY_SEQ_MASK];
+        render_submit(c, (c->kind == CMD_TEXT) ? &text_arena[c->text] : NULL);
+    }
+    frame_stats.draws = command_count;
+    last_stats = frame_stats;
+}
+
+RenderStats render_last_stats(void)
+{
+    return last_stats;
+}
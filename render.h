@@ -0,0 +1,76 @@
+#ifndef RENDER_H
+#define RENDER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "raylib.h"
+
+// deferred draw queue: calls are recorded with a layer/texture/primitive key,
+// then sorted and submitted so each texture and primitive switch happens once
+// per layer. order inside a layer only holds between commands sharing a
+// texture and primitive, so anything that must overlap in order gets its own layer
+
+#ifndef RENDER_MAX_COMMANDS
+#define RENDER_MAX_COMMANDS 4096
+#endif
+#define RENDER_TEXT_BYTES (16 * 1024)
+
+typedef enum {
+    LAYER_BACKGROUND = 0,
+    LAYER_PLANK,
+    LAYER_CANNONS,
+    LAYER_LOCK_ON,              // aim lines, under the shots
+    LAYER_BULLETS,
+    LAYER_GROUND,               // crates and boxes lying on the plank, over the shots
+    LAYER_DROPS,                // planks knocked out of crates
+    LAYER_PLAYER,
+    LAYER_HUD,
+    LAYER_DEBUG,
+    LAYER_COUNT
+} RenderLayer;
+
+typedef enum {
+    CMD_TEXTURE,
+    CMD_RECT,
+    CMD_RECT_LINES,
+    CMD_LINE,
+    CMD_TEXT
+} RenderCommandKind;
+
+typedef struct render_command {
+    RenderCommandKind kind;
+    Texture2D texture;
+    Rectangle source;
+    Rectangle dest;             // line endpoints in x,y / width,height for CMD_LINE
+    Vector2 origin;
+    float thick;                // line thickness, font size for CMD_TEXT
+    Color color;
+    int text;                   // offset into the frame's text arena
+} RenderCommand;
+
+typedef struct render_stats {
+    int draws;
+    int batches;                // texture or primitive switches, i.e. draw calls raylib issues
+    int dropped;
+} RenderStats;
+
+void render_begin(void);
+void render_texture(RenderLayer layer, Texture2D texture, Rectangle source, Rectangle dest, Vector2 origin, Color tint);
+void render_rect(RenderLayer layer, Rectangle rec, Color color);
+void render_rect_lines(RenderLayer layer, Rectangle rec, float thick, Color color);
+void render_line(RenderLayer layer, Vector2 from, Vector2 to, float thick, Color color);
+void render_text(RenderLayer layer, const char *text, int x, int y, int size, Color color);
+void render_flush(void);
+RenderStats render_last_stats(void);
+
+// backend, linked in from render_raylib.c for the game or render_soft.c for headless runs
+void render_submit(const RenderCommand *c, const char *text);
+unsigned int render_font_texture(void);
+void render_clear(Color color);
+RenderTexture2D render_target_load(int width, int height);
+bool render_target_valid(RenderTexture2D target);
+void render_target_begin(RenderTexture2D target);
+void render_target_end(void);
+void render_target_unload(RenderTexture2D target);
+
+#endif
@@ -0,0 +1,61 @@
+#include "render.h"
+
+// render queue backend that hands everything to raylib
+
+void render_submit(const RenderCommand *c, const char *text)
+{
+    switch (c->kind) {
+        case CMD_TEXTURE:
+            DrawTexturePro(c->texture, c->source, c->dest, c->origin, 0.0f, c->color);
+            break;
+        case CMD_RECT:
+            DrawRectangleRec(c->dest, c->color);
+            break;
+        case CMD_RECT_LINES:
+            DrawRectangleLinesEx(c->dest, c->thick, c->color);
+            break;
+        case CMD_LINE:
+            DrawLineEx((Vector2) {c->dest.x, c->dest.y}, (Vector2) {c->dest.width, c->dest.height}, c->thick, c->color);
+            break;
+        case CMD_TEXT:
+            DrawText(text, (int) c->dest.x, (int) c->dest.y, (int) c->thick, c->color);
+            break;
+        default:
+            break;
+    }
+}
+
+unsigned int render_font_texture(void)
+{
+    return GetFontDefault().texture.id;
+}
+
+void render_clear(Color color)
+{
+    ClearBackground(color);
+}
+
+RenderTexture2D render_target_load(int width, int height)
+{
+    return LoadRenderTexture(width, height);
+}
+
+bool render_target_valid(RenderTexture2D target)
+{
+    return IsRenderTextureValid(target);
+}
+
+void render_target_begin(RenderTexture2D target)
+{
+    BeginTextureMode(target);
+}
+
+void render_target_end(void)
+{
+    EndTextureMode();
+}
+
+void render_target_unload(RenderTexture2D target)
+{
+    UnloadRenderTexture(target);
+}
@@ -0,0 +1,397 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "render.h"
+#include "render_soft.h"
+#include "simd.h"
+
+#define SOFT_FONT_ID 0xFFFFFF
+
+typedef struct soft_surface {
+    uint32_t *pixels;
+    int width;
+    int height;
+    bool bottom_up;             // render targets are stored like gl so flipped source rects read the same
+} SoftSurface;
+
+typedef struct span {
+    int from, to;               // pixel centers in [from, to)
+} Span;
+
+static SoftSurface screen;
+static SoftSurface textures[SOFT_MAX_TEXTURES];     // texture id - 1
+static SoftSurface *target = &screen;
+static int cols[SOFT_MAX_WIDTH];
+static const int zero_cols[SOFT_MAX_WIDTH];
+static const uint32_t white = 0xFFFFFFFF;
+
+// 5x7 glyphs for ' ' to '~', one byte per column, bit 0 at the top
+static const uint8_t font[95][5] = {
+    {0x00,0x00,0x00,0x00,0x00}, {0x00,0x00,0x5F,0x00,0x00}, {0x00,0x07,0x00,0x07,0x00}, {0x14,0x7F,0x14,0x7F,0x14},
+    {0x24,0x2A,0x7F,0x2A,0x12}, {0x23,0x13,0x08,0x64,0x62}, {0x36,0x49,0x56,0x20,0x50}, {0x00,0x08,0x07,0x03,0x00},
+    {0x00,0x1C,0x22,0x41,0x00}, {0x00,0x41,0x22,0x1C,0x00}, {0x2A,0x1C,0x7F,0x1C,0x2A}, {0x08,0x08,0x3E,0x08,0x08},
+    {0x00,0x80,0x70,0x30,0x00}, {0x08,0x08,0x08,0x08,0x08}, {0x00,0x00,0x60,0x60,0x00}, {0x20,0x10,0x08,0x04,0x02},
+    {0x3E,0x51,0x49,0x45,0x3E}, {0x00,0x42,0x7F,0x40,0x00}, {0x72,0x49,0x49,0x49,0x46}, {0x21,0x41,0x49,0x4D,0x33},
+    {0x18,0x14,0x12,0x7F,0x10}, {0x27,0x45,0x45,0x45,0x39}, {0x3C,0x4A,0x49,0x49,0x31}, {0x41,0x21,0x11,0x09,0x07},
+    {0x36,0x49,0x49,0x49,0x36}, {0x46,0x49,0x49,0x29,0x1E}, {0x00,0x00,0x14,0x00,0x00}, {0x00,0x40,0x34,0x00,0x00},
+    {0x00,0x08,0x14,0x22,0x41}, {0x14,0x14,0x14,0x14,0x14}, {0x00,0x41,0x22,0x14,0x08}, {0x02,0x01,0x59,0x09,0x06},
+    {0x3E,0x41,0x5D,0x59,0x4E}, {0x7C,0x12,0x11,0x12,0x7C}, {0x7F,0x49,0x49,0x49,0x36}, {0x3E,0x41,0x41,0x41,0x22},
+    {0x7F,0x41,0x41,0x41,0x3E}, {0x7F,0x49,0x49,0x49,0x41}, {0x7F,0x09,0x09,0x09,0x01}, {0x3E,0x41,0x41,0x51,0x73},
+    {0x7F,0x08,0x08,0x08,0x7F}, {0x00,0x41,0x7F,0x41,0x00}, {0x20,0x40,0x41,0x3F,0x01}, {0x7F,0x08,0x14,0x22,0x41},
+    {0x7F,0x40,0x40,0x40,0x40}, {0x7F,0x02,0x1C,0x02,0x7F}, {0x7F,0x04,0x08,0x10,0x7F}, {0x3E,0x41,0x41,0x41,0x3E},
+    {0x7F,0x09,0x09,0x09,0x06}, {0x3E,0x41,0x51,0x21,0x5E}, {0x7F,0x09,0x19,0x29,0x46}, {0x26,0x49,0x49,0x49,0x32},
+    {0x03,0x01,0x7F,0x01,0x03}, {0x3F,0x40,0x40,0x40,0x3F}, {0x1F,0x20,0x40,0x20,0x1F}, {0x3F,0x40,0x38,0x40,0x3F},
+    {0x63,0x14,0x08,0x14,0x63}, {0x03,0x04,0x78,0x04,0x03}, {0x61,0x59,0x49,0x4D,0x43}, {0x00,0x7F,0x41,0x41,0x41},
+    {0x02,0x04,0x08,0x10,0x20}, {0x00,0x41,0x41,0x41,0x7F}, {0x04,0x02,0x01,0x02,0x04}, {0x40,0x40,0x40,0x40,0x40},
+    {0x00,0x03,0x07,0x08,0x00}, {0x20,0x54,0x54,0x78,0x40}, {0x7F,0x28,0x44,0x44,0x38}, {0x38,0x44,0x44,0x44,0x28},
+    {0x38,0x44,0x44,0x28,0x7F}, {0x38,0x54,0x54,0x54,0x18}, {0x00,0x08,0x7E,0x09,0x02}, {0x18,0xA4,0xA4,0x9C,0x78},
+    {0x7F,0x08,0x04,0x04,0x78}, {0x00,0x44,0x7D,0x40,0x00}, {0x20,0x40,0x40,0x3D,0x00}, {0x7F,0x10,0x28,0x44,0x00},
+    {0x00,0x41,0x7F,0x40,0x00}, {0x7C,0x04,0x78,0x04,0x78}, {0x7C,0x08,0x04,0x04,0x78}, {0x38,0x44,0x44,0x44,0x38},
+    {0xFC,0x18,0x24,0x24,0x18}, {0x18,0x24,0x24,0x18,0xFC}, {0x7C,0x08,0x04,0x04,0x08}, {0x48,0x54,0x54,0x54,0x24},
+    {0x04,0x04,0x3F,0x44,0x24}, {0x3C,0x40,0x40,0x20,0x7C}, {0x1C,0x20,0x40,0x20,0x1C}, {0x3C,0x40,0x30,0x40,0x3C},
+    {0x44,0x28,0x10,0x28,0x44}, {0x4C,0x90,0x90,0x90,0x7C}, {0x44,0x64,0x54,0x4C,0x44}, {0x00,0x08,0x36,0x41,0x00},
+    {0x00,0x00,0x77,0x00,0x00}, {0x00,0x41,0x36,0x08,0x00}, {0x02,0x01,0x02,0x04,0x02},
+};
+
+static inline uint32_t pack(Color c)
+{
+    return (uint32_t) c.r | ((uint32_t) c.g << 8) | ((uint32_t) c.b << 16) | ((uint32_t) c.a << 24);
+}
+
+static bool surface_alloc(SoftSurface *s, int width, int height, bool bottom_up)
+{
+    if (width <= 0 || height <= 0 || width > SOFT_MAX_WIDTH) return false;
+    s->pixels = calloc((size_t) width * height, sizeof(uint32_t));
+    if (!s->pixels) return false;
+    s->width = width;
+    s->height = height;
+    s->bottom_up = bottom_up;
+    return true;
+}
+
+static void surface_free(SoftSurface *s)
+{
+    free(s->pixels);
+    *s = (SoftSurface) {0};
+}
+
+static inline uint32_t *surface_row(SoftSurface *s, int y)
+{
+    return s->pixels + (size_t) (s->bottom_up ? s->height - 1 - y : y) * s->width;
+}
+
+static SoftSurface *texture_surface(unsigned int id)
+{
+    if (id == 0 || id > SOFT_MAX_TEXTURES || !textures[id - 1].pixels) return NULL;
+    return &textures[id - 1];
+}
+
+static int texture_slot(void)
+{
+    for (int i = 0; i < SOFT_MAX_TEXTURES; i++) {
+        if (!textures[i].pixels) return i;
+    }
+    return -1;
+}
+
+// pixels whose centers fall inside [from, from + size), clipped to [0, limit)
+static inline Span covered(float from, float size, int limit)
+{
+    Span s = {(int) ceilf(from - 0.5f), (int) ceilf(from + size - 0.5f)};
+    if (s.from < 0) s.from = 0;
+    if (s.to > limit) s.to = limit;
+    return s;
+}
+
+static void fill_rect(Rectangle r, uint32_t color)
+{
+    Span xs = covered(r.x, r.width, target->width);
+    Span ys = covered(r.y, r.height, target->height);
+    if (xs.from >= xs.to) return;
+    for (int y = ys.from; y < ys.to; y++) {
+        simd.blit_span(surface_row(target, y) + xs.from, &white, zero_cols, xs.to - xs.from, color);
+    }
+}
+
+// nearest sampling at pixel centers, raylib's flip rules: a negative source
+// size mirrors the same region rather than selecting the one before it
+static void draw_texture(const RenderCommand *c)
+{
+    const SoftSurface *tex = texture_surface(c->texture.id);
+    if (!tex) return;
+    Rectangle src = c->source;
+    bool flip_x = src.width < 0;
+    bool flip_y = src.height < 0;
+    float src_w = fabsf(src.width);
+    float src_h = fabsf(src.height);
+    Rectangle dst = {c->dest.x - c->origin.x, c->dest.y - c->origin.y, fabsf(c->dest.width), fabsf(c->dest.height)};
+    if (dst.width <= 0 || dst.height <= 0) return;
+
+    Span xs = covered(dst.x, dst.width, target->width);
+    Span ys = covered(dst.y, dst.height, target->height);
+    if (xs.from >= xs.to) return;
+    for (int x = xs.from; x < xs.to; x++) {
+        float u = ((float) x + 0.5f - dst.x) / dst.width;
+        if (flip_x) u = 1.0f - u;
+        int tx = (int) floorf(src.x + u * src_w);
+        cols[x - xs.from] = (tx < 0) ? 0 : (tx >= tex->width) ? tex->width - 1 : tx;
+    }
+    uint32_t tint = pack(c->color);
+    for (int y = ys.from; y < ys.to; y++) {
+        float v = ((float) y + 0.5f - dst.y) / dst.height;
+        if (flip_y) v = 1.0f - v;
+        int ty = (int) floorf(src.y + v * src_h);
+        ty = (ty < 0) ? 0 : (ty >= tex->height) ? tex->height - 1 : ty;
+        simd.blit_span(surface_row(target, y) + xs.from, tex->pixels + (size_t) ty * tex->width, cols, xs.to - xs.from, tint);
+    }
+}
+
+// same four strips raylib draws, so corners are covered once
+static void draw_rect_lines(Rectangle r, float thick, uint32_t color)
+{
+    if (thick > r.width || thick > r.height) {
+        if (r.width >= r.height) thick = r.height * 0.5f;
+        else thick = r.width * 0.5f;
+    }
+    fill_rect((Rectangle) {r.x, r.y, r.width, thick}, color);
+    fill_rect((Rectangle) {r.x, r.y + r.height - thick, r.width, thick}, color);
+    fill_rect((Rectangle) {r.x, r.y + thick, thick, r.height - 2 * thick}, color);
+    fill_rect((Rectangle) {r.x + r.width - thick, r.y + thick, thick, r.height - 2 * thick}, color);
+}
+
+// thick line as the quad around it, scanlines cross a convex shape in one span
+static void draw_line(Vector2 a, Vector2 b, float thick, uint32_t color)
+{
+    float dx = b.x - a.x;
+    float dy = b.y - a.y;
+    float len = sqrtf(dx * dx + dy * dy);
+    if (len == 0.0f) return;
+    float nx = -dy / len * thick * 0.5f;
+    float ny = dx / len * thick * 0.5f;
+    Vector2 quad[4] = {
+        {a.x + nx, a.y + ny}, {b.x + nx, b.y + ny},
+        {b.x - nx, b.y - ny}, {a.x - nx, a.y - ny},
+    };
+    float top = quad[0].y, bottom = quad[0].y;
+    for (int i = 1; i < 4; i++) {
+        top = fminf(top, quad[i].y);
+        bottom = fmaxf(bottom, quad[i].y);
+    }
+    Span ys = covered(top, bottom - top, target->height);
+    for (int y = ys.from; y < ys.to; y++) {
+        float py = (float) y + 0.5f;
+        float left = INFINITY, right = -INFINITY;
+        for (int i = 0; i < 4; i++) {
+            Vector2 p = quad[i], q = quad[(i + 1) & 3];
+            if ((py < p.y) == (py < q.y)) continue;
+            float x = p.x + (py - p.y) * (q.x - p.x) / (q.y - p.y);
+            left = fminf(left, x);
+            right = fmaxf(right, x);
+        }
+        if (left >= right) continue;
+        Span xs = covered(left, right - left, target->width);
+        if (xs.from >= xs.to) continue;
+        simd.blit_span(surface_row(target, y) + xs.from, &white, zero_cols, xs.to - xs.from, color);
+    }
+}
+
+// sized like raylib's default font: 10px base, one pixel of spacing per 10px
+static void draw_text(const char *text, float x, float y, int size, uint32_t color)
+{
+    if (size < 10) size = 10;
+    float scale = size / 10.0f;
+    float pen = x;
+    for (const char *ch = text; *ch; ch++) {
+        if (*ch == '\n') {
+            pen = x;
+            y += size + 2 * scale;
+            continue;
+        }
+        int glyph = (*ch < ' ' || *ch > '~') ? '?' - ' ' : *ch - ' ';
+        for (int col = 0; col < 5; col++) {
+            uint8_t bits = font[glyph][col];
+            for (int row = 0; bits; row++, bits >>= 1) {
+                if (bits & 1) fill_rect((Rectangle) {pen + col * scale, y + (row + 1) * scale, scale, scale}, color);
+            }
+        }
+        pen += 6 * scale;
+    }
+}
+
+void render_submit(const RenderCommand *c, const char *text)
+{
+    uint32_t color = pack(c->color);
+    switch (c->kind) {
+        case CMD_TEXTURE:
+            draw_texture(c);
+            break;
+        case CMD_RECT:
+            fill_rect(c->dest, color);
+            break;
+        case CMD_RECT_LINES:
+            draw_rect_lines(c->dest, c->thick, color);
+            break;
+        case CMD_LINE:
+            draw_line((Vector2) {c->dest.x, c->dest.y}, (Vector2) {c->dest.width, c->dest.height}, c->thick, color);
+            break;
+        case CMD_TEXT:
+            draw_text(text, c->dest.x, c->dest.y, (int) c->thick, color);
+            break;
+        default:
+            break;
+    }
+}
+
+unsigned int render_font_texture(void)
+{
+    return SOFT_FONT_ID;
+}
+
+void render_clear(Color color)
+{
+    uint32_t p = pack(color);
+    size_t n = (size_t) target->width * target->height;
+    for (size_t i = 0; i < n; i++) target->pixels[i] = p;
+}
+
+RenderTexture2D render_target_load(int width, int height)
+{
+    int slot = texture_slot();
+    if (slot < 0 || !surface_alloc(&textures[slot], width, height, true)) return (RenderTexture2D) {0};
+    Texture2D tex = {(unsigned int) slot + 1, width, height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+    return (RenderTexture2D) {tex.id, tex, {0}};
+}
+
+bool render_target_valid(RenderTexture2D target)
+{
+    return texture_surface(target.texture.id) != NULL;
+}
+
+void render_target_begin(RenderTexture2D t)
+{
+    SoftSurface *s = texture_surface(t.texture.id);
+    target = s ? s : &screen;
+}
+
+void render_target_end(void)
+{
+    target = &screen;
+}
+
+void render_target_unload(RenderTexture2D t)
+{
+    soft_texture_unload(t.texture);
+}
+
+// stand in for the spritesheet when no decoded copy is given: a flat colour per
+// 32px cell with a darker border, enough to tell every sprite region apart
+uint32_t *soft_placeholder_sheet(void)
+{
+    uint32_t *pixels = malloc(SOFT_SHEET_SIZE * SOFT_SHEET_SIZE * sizeof(uint32_t));
+    if (!pixels) return NULL;
+    for (int y = 0; y < SOFT_SHEET_SIZE; y++) {
+        for (int x = 0; x < SOFT_SHEET_SIZE; x++) {
+            uint32_t h = (uint32_t) ((x / 32) * 73856093u) ^ (uint32_t) ((y / 32) * 19349663u);
+            h *= 0x9E3779B1u;
+            bool border = (x % 32) == 0 || (y % 32) == 0 || (x % 32) == 31 || (y % 32) == 31;
+            uint32_t rgb = border ? ((h >> 9) & 0x3F3F3F) : (h >> 8);
+            pixels[y * SOFT_SHEET_SIZE + x] = rgb | 0xFF000000u;
+        }
+    }
+    return pixels;
+}
+
+bool soft_init(int width, int height)
+{
+    soft_shutdown();
+    simd_init();
+    return surface_alloc(&screen, width, height, false);
+}
+
+void soft_shutdown(void)
+{
+    for (int i = 0; i < SOFT_MAX_TEXTURES; i++) surface_free(&textures[i]);
+    surface_free(&screen);
+    target = &screen;
+}
+
+Texture2D soft_texture_load(const uint32_t *pixels, int width, int height)
+{
+    int slot = texture_slot();
+    if (slot < 0 || !surface_alloc(&textures[slot], width, height, false)) return (Texture2D) {0};
+    memcpy(textures[slot].pixels, pixels, (size_t) width * height * sizeof(uint32_t));
+    return (Texture2D) {(unsigned int) slot + 1, width, height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+}
+
+void soft_texture_unload(Texture2D texture)
+{
+    SoftSurface *s = texture_surface(texture.id);
+    if (!s) return;
+    if (target == s) target = &screen;
+    surface_free(s);
+}
+
+const uint32_t *soft_framebuffer(void)
+{
+    return screen.pixels;
+}
+
+bool soft_image_write(const char *path, const uint32_t *pixels, int width, int height)
+{
+    FILE *f = fopen(path, "wb");
+    if (!f) return false;
+    fprintf(f, "P7\nWIDTH %d\nHEIGHT %d\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n", width, height);
+    bool ok = true;
+    uint8_t row[4 * SOFT_MAX_WIDTH];
+    for (int y = 0; y < height && ok; y++) {
+        for (int x = 0; x < width; x++) {
+            uint32_t p = pixels[(size_t) y * width + x];
+            for (int c = 0; c < 4; c++) row[4 * x + c] = (uint8_t) (p >> (8 * c));
+        }
+        ok = fwrite(row, 4, (size_t) width, f) == (size_t) width;
+    }
+    return (fclose(f) == 0) && ok;
+}
+
+uint32_t *soft_image_read(const char *path, int *width, int *height)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) return NULL;
+    int w = 0, h = 0, depth = 0, maxval = 0;
+    char token[32];
+    bool header = fscanf(f, "%31s", token) == 1 && strcmp(token, "P7") == 0;
+    while (header && fscanf(f, "%31s", token) == 1) {
+        if (strcmp(token, "ENDHDR") == 0) break;
+        if (strcmp(token, "WIDTH") == 0) header = fscanf(f, "%d", &w) == 1;
+        else if (strcmp(token, "HEIGHT") == 0) header = fscanf(f, "%d", &h) == 1;
+        else if (strcmp(token, "DEPTH") == 0) header = fscanf(f, "%d", &depth) == 1;
+        else if (strcmp(token, "MAXVAL") == 0) header = fscanf(f, "%d", &maxval) == 1;
+        else if (strcmp(token, "TUPLTYPE") == 0) header = fscanf(f, "%31s", token) == 1;
+        else header = false;
+    }
+    // exactly one whitespace byte ends the header
+    if (!header || fgetc(f) == EOF || w <= 0 || h <= 0 || w > SOFT_MAX_WIDTH || depth != 4 || maxval != 255) {
+        fclose(f);
+        return NULL;
+    }
+    uint32_t *pixels = malloc((size_t) w * h * sizeof(uint32_t));
+    uint8_t row[4 * SOFT_MAX_WIDTH];
+    for (int y = 0; pixels && y < h; y++) {
+        if (fread(row, 4, (size_t) w, f) != (size_t) w) {
+            free(pixels);
+            pixels = NULL;
+            break;
+        }
+        for (int x = 0; x < w; x++) {
+            pixels[(size_t) y * w + x] = (uint32_t) row[4 * x] | ((uint32_t) row[4 * x + 1] << 8) |
+                                         ((uint32_t) row[4 * x + 2] << 16) | ((uint32_t) row[4 * x + 3] << 24);
+        }
+    }
+    fclose(f);
+    if (pixels) {
+        *width = w;
+        *height = h;
+    }
+    return pixels;
+}
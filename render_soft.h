@@ -0,0 +1,28 @@
+#ifndef RENDER_SOFT_H
+#define RENDER_SOFT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "raylib.h"
+
+// cpu rasterizer backend for the render queue, for machines with no gpu or display
+// covers what the game draws: axis aligned textured quads with flipped sources
+// and tint, filled and outlined rects, thick lines and text in a built in 5x7 font
+// pixels are rgba8 packed little endian, the screen is stored top down
+
+#define SOFT_MAX_WIDTH 4096
+#define SOFT_MAX_TEXTURES 16
+#define SOFT_SHEET_SIZE 288
+
+bool soft_init(int width, int height);
+void soft_shutdown(void);
+Texture2D soft_texture_load(const uint32_t *pixels, int width, int height);
+void soft_texture_unload(Texture2D texture);
+const uint32_t *soft_framebuffer(void);
+uint32_t *soft_placeholder_sheet(void);
+
+// rgba pam (P7) images, read allocates and the caller frees
+bool soft_image_write(const char *path, const uint32_t *pixels, int width, int height);
+uint32_t *soft_image_read(const char *path, int *width, int *height);
+
+#endif
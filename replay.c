@@ -0,0 +1,199 @@
+#include <stdlib.h>
+#include <string.h>
+#include "replay.h"
+
+uint8_t pack_input(SimInput input)
+{
+    uint8_t bits = 0;
+    if (input.up) bits |= INPUT_UP;
+    if (input.down) bits |= INPUT_DOWN;
+    if (input.left) bits |= INPUT_LEFT;
+    if (input.right) bits |= INPUT_RIGHT;
+    if (input.space_pressed) bits |= INPUT_SPACE;
+    if (input.debug) bits |= INPUT_DEBUG;
+    return bits;
+}
+
+SimInput unpack_input(uint8_t bits)
+{
+    return (SimInput) {
+        .up = (bits & INPUT_UP) != 0,
+        .down = (bits & INPUT_DOWN) != 0,
+        .left = (bits & INPUT_LEFT) != 0,
+        .right = (bits & INPUT_RIGHT) != 0,
+        .space_pressed = (bits & INPUT_SPACE) != 0,
+        .debug = (bits & INPUT_DEBUG) != 0,
+    };
+}
+
+WanderInput wander_init(uint64_t seed)
+{
+    WanderInput wi = {.state = seed ^ 0xD1B54A32D192ED03ull};
+    if (wi.state == 0) wi.state = 1;
+    return wi;
+}
+
+static uint32_t wander_next(WanderInput *wi)
+{
+    wi->state ^= wi->state << 13;
+    wi->state ^= wi->state >> 7;
+    wi->state ^= wi->state << 17;
+    return (uint32_t) (wi->state >> 32);
+}
+
+SimInput wander_input(WanderInput *wi)
+{
+    if (wi->hold_ticks <= 0) {
+        uint32_t r = wander_next(wi);
+        wi->held = (SimInput) {
+            .up = (r & 0x3) == 0,
+            .down = (r & 0xC) == 0,
+            .left = (r & 0x30) == 0,
+            .right = (r & 0xC0) == 0,
+        };
+        wi->hold_ticks = 1 + (int) ((r >> 8) % 60);
+    }
+    wi->hold_ticks--;
+    SimInput input = wi->held;
+    input.space_pressed = (wander_next(wi) % 20) == 0;
+    return input;
+}
+
+static void put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t) v;
+    p[1] = (uint8_t) (v >> 8);
+}
+
+static void put_u64(uint8_t *p, uint64_t v)
+{
+    for (int i = 0; i < 8; i++) p[i] = (uint8_t) (v >> (8 * i));
+}
+
+static uint16_t get_u16(const uint8_t *p)
+{
+    return (uint16_t) (p[0] | (p[1] << 8));
+}
+
+static uint64_t get_u64(const uint8_t *p)
+{
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) v |= (uint64_t) p[i] << (8 * i);
+    return v;
+}
+
+static void flush_run(ReplayWriter *rw)
+{
+    if (rw->run_length == 0) return;
+    uint8_t record[6];
+    int n = 0;
+    record[n++] = rw->run_bits;
+    uint32_t v = rw->run_length;
+    while (v >= 0x80) {
+        record[n++] = (uint8_t) (v | 0x80);
+        v >>= 7;
+    }
+    record[n++] = (uint8_t) v;
+    fwrite(record, 1, n, rw->file);
+    rw->run_length = 0;
+}
+
+bool replay_writer_open(ReplayWriter *rw, const char *path, uint64_t seed)
+{
+    *rw = (ReplayWriter) {0};
+    rw->file = fopen(path, "wb");
+    if (!rw->file) return false;
+
+    uint8_t header[REPLAY_HEADER_SIZE];
+    memcpy(header, REPLAY_MAGIC, 4);
+    put_u16(header + 4, REPLAY_VERSION);
+    put_u16(header + 6, SIM_TICK_RATE);
+    put_u64(header + 8, seed);
+    fwrite(header, 1, sizeof(header), rw->file);
+    return true;
+}
+
+void replay_writer_push(ReplayWriter *rw, SimInput input)
+{
+    if (!rw->file) return;
+    uint8_t bits = pack_input(input);
+    if (rw->run_length > 0 && (bits != rw->run_bits || rw->run_length == UINT32_MAX)) {
+        flush_run(rw);
+    }
+    rw->run_bits = bits;
+    rw->run_length++;
+    rw->ticks++;
+}
+
+void replay_writer_close(ReplayWriter *rw)
+{
+    if (!rw->file) return;
+    flush_run(rw);
+    fclose(rw->file);
+    rw->file = NULL;
+}
+
+bool replay_reader_open(ReplayReader *rr, const char *path)
+{
+    *rr = (ReplayReader) {0};
+    FILE *f = fopen(path, "rb");
+    if (!f) return false;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    if (size < REPLAY_HEADER_SIZE) {
+        fclose(f);
+        return false;
+    }
+    rr->data = malloc((size_t) size);
+    if (!rr->data || fread(rr->data, 1, (size_t) size, f) != (size_t) size) {
+        fclose(f);
+        replay_reader_close(rr);
+        return false;
+    }
+    fclose(f);
+    rr->size = (size_t) size;
+
+    if (memcmp(rr->data, REPLAY_MAGIC, 4) != 0 || get_u16(rr->data + 4) != REPLAY_VERSION) {
+        replay_reader_close(rr);
+        return false;
+    }
+    rr->tick_rate = get_u16(rr->data + 6);
+    rr->seed = get_u64(rr->data + 8);
+    // inputs are per tick, a different tick rate would not reproduce the run
+    if (rr->tick_rate != SIM_TICK_RATE) {
+        replay_reader_close(rr);
+        return false;
+    }
+    rr->cursor = REPLAY_HEADER_SIZE;
+    return true;
+}
+
+bool replay_reader_next(ReplayReader *rr, SimInput *input)
+{
+    while (rr->run_remaining == 0) {
+        if (rr->cursor >= rr->size) return false;
+        rr->run_bits = rr->data[rr->cursor++];
+        uint32_t v = 0;
+        int shift = 0;
+        for (;;) {
+            if (rr->cursor >= rr->size || shift > 28) return false;
+            uint8_t byte = rr->data[rr->cursor++];
+            v |= (uint32_t) (byte & 0x7F) << shift;
+            if (!(byte & 0x80)) break;
+            shift += 7;
+        }
+        rr->run_remaining = v;
+    }
+    rr->run_remaining--;
+    rr->ticks++;
+    *input = unpack_input(rr->run_bits);
+    return true;
+}
+
+void replay_reader_close(ReplayReader *rr)
+{
+    free(rr->data);
+    rr->data = NULL;
+    rr->size = 0;
+}
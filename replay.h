@@ -0,0 +1,66 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "sim.h"
+
+// replay file: "20GR", u16 version, u16 tick rate, u64 seed (little endian)
+// followed by runs of [u8 input bits][varint tick count] until end of file
+
+#define REPLAY_MAGIC "20GR"
+#define REPLAY_VERSION 1
+#define REPLAY_HEADER_SIZE 16
+
+typedef enum {
+    INPUT_UP    = 1 << 0,
+    INPUT_DOWN  = 1 << 1,
+    INPUT_LEFT  = 1 << 2,
+    INPUT_RIGHT = 1 << 3,
+    INPUT_SPACE = 1 << 4,
+    INPUT_DEBUG = 1 << 5
+} InputBits;
+
+typedef struct replay_writer {
+    FILE *file;
+    uint8_t run_bits;
+    uint32_t run_length;
+    uint64_t ticks;
+} ReplayWriter;
+
+typedef struct replay_reader {
+    uint8_t *data;
+    size_t size;
+    size_t cursor;
+    uint8_t run_bits;
+    uint32_t run_remaining;
+    uint64_t seed;
+    int tick_rate;
+    uint64_t ticks;
+} ReplayReader;
+
+// stand in player for drivers without one: holds a random arrow combination for
+// a random number of ticks and taps space now and then, the same for a given seed
+typedef struct wander_input {
+    uint64_t state;
+    SimInput held;
+    int hold_ticks;
+} WanderInput;
+
+uint8_t pack_input(SimInput input);
+SimInput unpack_input(uint8_t bits);
+
+WanderInput wander_init(uint64_t seed);
+SimInput wander_input(WanderInput *wi);
+
+bool replay_writer_open(ReplayWriter *rw, const char *path, uint64_t seed);
+void replay_writer_push(ReplayWriter *rw, SimInput input);
+void replay_writer_close(ReplayWriter *rw);
+
+bool replay_reader_open(ReplayReader *rr, const char *path);
+bool replay_reader_next(ReplayReader *rr, SimInput *input);
+void replay_reader_close(ReplayReader *rr);
+
+#endif
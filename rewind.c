@@ -0,0 +1,140 @@
+#include <string.h>
+#include "rewind.h"
+
+#define RUN_MAX 0xFFFF
+#define MIN_GAP 4                   // shorter equal stretches stay inside a literal run, a new token costs 4 bytes
+
+static void put_u16(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t) v;
+    p[1] = (uint8_t) (v >> 8);
+}
+
+static uint32_t get_u16(const uint8_t *p)
+{
+    return (uint32_t) (p[0] | (p[1] << 8));
+}
+
+// tokens of [u16 equal bytes][u16 literal bytes][literals xored], literals hold at
+// least one changed byte per MIN_GAP so the output never passes REWIND_SCRATCH
+static uint32_t encode(uint8_t *out, const uint8_t *a, const uint8_t *b, size_t n)
+{
+    uint8_t *o = out;
+    size_t i = 0;
+    while (i < n) {
+        size_t same = 0;
+        while (i + same + 8 <= n && same + 8 <= RUN_MAX && memcmp(a + i + same, b + i + same, 8) == 0) same += 8;
+        while (i + same < n && same < RUN_MAX && a[i + same] == b[i + same]) same++;
+        i += same;
+
+        size_t start = i;
+        while (i < n && i - start < RUN_MAX) {
+            if (a[i] != b[i]) {
+                i++;
+                continue;
+            }
+            size_t gap = 0;
+            while (gap < MIN_GAP && i + gap < n && a[i + gap] == b[i + gap]) gap++;
+            if (gap == MIN_GAP || i + gap == n) break;
+            i += gap;
+            if (i - start > RUN_MAX) i = start + RUN_MAX;
+        }
+        size_t lits = i - start;
+        if (same == 0 && lits == 0) break;
+        put_u16(o, (uint32_t) same);
+        put_u16(o + 2, (uint32_t) lits);
+        o += 4;
+        for (size_t k = 0; k < lits; k++) o[k] = a[start + k] ^ b[start + k];
+        o += lits;
+    }
+    return (uint32_t) (o - out);
+}
+
+static void apply(uint8_t *w, const uint8_t *delta, uint32_t size)
+{
+    const uint8_t *d = delta;
+    const uint8_t *end = delta + size;
+    while (d < end) {
+        w += get_u16(d);
+        uint32_t lits = get_u16(d + 2);
+        d += 4;
+        for (uint32_t k = 0; k < lits; k++) w[k] ^= d[k];
+        w += lits;
+        d += lits;
+    }
+}
+
+static void drop_oldest(RewindBuffer *rb)
+{
+    rb->oldest = (rb->oldest + 1) % REWIND_MAX_TICKS;
+    rb->count--;
+    if (rb->count == 0) rb->write = 0;
+}
+
+// the bytes in use run from the oldest entry round to write; a gap left at the end
+// of data when a delta wraps is given back once the entries before it are dropped
+static bool place(RewindBuffer *rb, uint32_t size, uint32_t *offset)
+{
+    if (rb->count == 0) {
+        *offset = 0;
+        return true;
+    }
+    uint32_t oldest = rb->entries[rb->oldest].offset;
+    if (rb->write >= oldest) {
+        if (rb->write + size <= REWIND_BUDGET) {
+            *offset = rb->write;
+            return true;
+        }
+        if (size < oldest) {
+            *offset = 0;
+            return true;
+        }
+        return false;
+    }
+    if (rb->write + size < oldest) {
+        *offset = rb->write;
+        return true;
+    }
+    return false;
+}
+
+void rewind_reset(RewindBuffer *rb, const World *w)
+{
+    rb->newest = *w;
+    rb->oldest = 0;
+    rb->count = 0;
+    rb->write = 0;
+}
+
+void rewind_push(RewindBuffer *rb, const World *w)
+{
+    uint32_t size = encode(rb->scratch, (const uint8_t *) w, (const uint8_t *) &rb->newest, sizeof(World));
+    rb->newest = *w;
+    if (rb->count == REWIND_MAX_TICKS) drop_oldest(rb);
+    uint32_t offset;
+    while (!place(rb, size, &offset)) drop_oldest(rb);
+
+    memcpy(rb->data + offset, rb->scratch, size);
+    rb->entries[(rb->oldest + rb->count) % REWIND_MAX_TICKS] = (RewindEntry) {offset, size};
+    rb->count++;
+    rb->write = offset + size;
+}
+
+// steps newest back one tick and copies it to w, false once the history runs out
+bool rewind_pop(RewindBuffer *rb, World *w)
+{
+    if (rb->count == 0) return false;
+    RewindEntry *e = &rb->entries[(rb->oldest + rb->count - 1) % REWIND_MAX_TICKS];
+    apply((uint8_t *) &rb->newest, rb->data + e->offset, e->size);
+    rb->count--;
+    rb->write = (rb->count > 0) ? e->offset : 0;
+    *w = rb->newest;
+    return true;
+}
+
+size_t rewind_bytes(const RewindBuffer *rb)
+{
+    size_t bytes = 0;
+    for (int i = 0; i < rb->count; i++) bytes += rb->entries[(rb->oldest + i) % REWIND_MAX_TICKS].size;
+    return bytes;
+}
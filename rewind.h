@@ -0,0 +1,42 @@
+#ifndef REWIND_H
+#define REWIND_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sim.h"
+
+// per tick history for scrubbing backwards: each tick stores the xor of the world
+// against the one before, run length coded so the bytes that didn't change cost
+// nothing. xor is its own inverse, so stepping back from the newest world needs no
+// keyframes and the oldest ticks can simply be dropped when the budget runs out
+
+#define REWIND_BUDGET (1 << 20)                     // delta bytes, a busy tick codes to a few hundred
+#define REWIND_MAX_TICKS (20 * SIM_TICK_RATE)
+#define REWIND_SCRATCH (2 * sizeof(World) + 16)      // worst case coding, a literal run per changed byte pair
+
+typedef struct rewind_entry {
+    uint32_t offset;
+    uint32_t size;
+} RewindEntry;
+
+typedef struct rewind_buffer {
+    World newest;                   // last world pushed or popped to, deltas run backwards from here
+    RewindEntry entries[REWIND_MAX_TICKS];
+    int oldest;
+    int count;
+    uint32_t write;                 // where the next delta goes in data
+    uint8_t scratch[REWIND_SCRATCH];
+    uint8_t data[REWIND_BUDGET];
+} RewindBuffer;
+
+void rewind_reset(RewindBuffer *rb, const World *w);
+void rewind_push(RewindBuffer *rb, const World *w);
+bool rewind_pop(RewindBuffer *rb, World *w);
+size_t rewind_bytes(const RewindBuffer *rb);
+
+static inline float rewind_seconds(const RewindBuffer *rb)
+{
+    return (float) rb->count / SIM_TICK_RATE;
+}
+
+#endif
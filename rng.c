@@ -0,0 +1,113 @@
+#include "rng.h"
+
+#define PHILOX_M0 0xD2511F53u
+#define PHILOX_M1 0xCD9E8D57u
+#define PHILOX_W0 0x9E3779B9u
+#define PHILOX_W1 0xBB67AE85u
+#define PHILOX_ROUNDS 10
+
+static inline void philox_block(const uint32_t key[2], uint64_t block, uint32_t out[4])
+{
+    uint32_t c0 = (uint32_t) block;
+    uint32_t c1 = (uint32_t) (block >> 32);
+    uint32_t c2 = 0;
+    uint32_t c3 = 0;
+    uint32_t k0 = key[0];
+    uint32_t k1 = key[1];
+
+    for (int r = 0; r < PHILOX_ROUNDS; r++) {
+        uint64_t p0 = (uint64_t) PHILOX_M0 * c0;
+        uint64_t p1 = (uint64_t) PHILOX_M1 * c2;
+        uint32_t n0 = (uint32_t) (p1 >> 32) ^ c1 ^ k0;
+        uint32_t n2 = (uint32_t) (p0 >> 32) ^ c3 ^ k1;
+        c1 = (uint32_t) p1;
+        c3 = (uint32_t) p0;
+        c0 = n0;
+        c2 = n2;
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+    out[0] = c0;
+    out[1] = c1;
+    out[2] = c2;
+    out[3] = c3;
+}
+
+static inline int map_range(uint32_t r, int min, int max)
+{
+    uint32_t span = (uint32_t) (max - min) + 1u;
+    if (span == 0) return (int) r;
+    return min + (int) (((uint64_t) r * span) >> 32);
+}
+
+RngStream rng_stream(uint64_t seed, uint32_t stream_id)
+{
+    RngStream s = {
+        .key = {(uint32_t) seed ^ stream_id, (uint32_t) (seed >> 32)},
+        .counter = 0,
+    };
+    // scramble so neighbouring seeds and ids don't yield related keys
+    uint32_t mixed[4];
+    philox_block(s.key, ((uint64_t) stream_id << 32) | 0xA5A5A5A5u, mixed);
+    s.key[0] = mixed[0];
+    s.key[1] = mixed[1];
+    return s;
+}
+
+RngStream rng_split(const RngStream *parent, uint32_t child_id)
+{
+    uint32_t mixed[4];
+    philox_block(parent->key, ~(uint64_t) child_id, mixed);
+    return (RngStream) {
+        .key = {mixed[0] ^ mixed[2], mixed[1] ^ mixed[3]},
+        .counter = 0,
+    };
+}
+
+uint32_t rng_next(RngStream *s)
+{
+    uint32_t out[4];
+    philox_block(s->key, s->counter >> 2, out);
+    return out[s->counter++ & 3];
+}
+
+int rng_range(RngStream *s, int min, int max)
+{
+    if (min > max) {
+        int tmp = max;
+        max = min;
+        min = tmp;
+    }
+    return map_range(rng_next(s), min, max);
+}
+
+// each block depends only on its counter, so whole blocks are generated in a
+// branch-free loop the compiler can vectorise; the ragged ends go through rng_next
+void rng_fill(RngStream *s, uint32_t *out, int n)
+{
+    int i = 0;
+    while (i < n && (s->counter & 3) != 0) out[i++] = rng_next(s);
+
+    int blocks = (n - i) / 4;
+    uint64_t first = s->counter >> 2;
+    for (int b = 0; b < blocks; b++) {
+        philox_block(s->key, first + (uint64_t) b, &out[i + 4 * b]);
+    }
+    i += 4 * blocks;
+    s->counter += 4 * (uint64_t) blocks;
+
+    while (i < n) out[i++] = rng_next(s);
+}
+
+void rng_fill_range(RngStream *s, int *out, int n, int min, int max)
+{
+    if (min > max) {
+        int tmp = max;
+        max = min;
+        min = tmp;
+    }
+    rng_fill(s, (uint32_t *) out, n);
+    for (int i = 0; i < n; i++) {
+        out[i] = map_range((uint32_t) out[i], min, max);
+    }
+}
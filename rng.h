@@ -0,0 +1,30 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+// counter-based philox4x32-10 streams: the output for (key, counter) is a pure
+// function, so streams never share hidden state and can be split or batched freely
+
+typedef struct rng_stream {
+    uint32_t key[2];
+    uint64_t counter;
+} RngStream;
+
+typedef enum {
+    RNG_CANNON_MOVE = 1,
+    RNG_CANNON_FIRE,
+    RNG_CRATE_SPAWN,
+    RNG_PLANK_JITTER,
+} RngSubsystem;
+
+#define RNG_STREAM_ID(subsystem, entity) (((uint32_t) (subsystem) << 16) | ((uint32_t) (entity) & 0xFFFF))
+
+RngStream rng_stream(uint64_t seed, uint32_t stream_id);
+RngStream rng_split(const RngStream *parent, uint32_t child_id);
+uint32_t rng_next(RngStream *s);
+int rng_range(RngStream *s, int min, int max);
+void rng_fill(RngStream *s, uint32_t *out, int n);
+void rng_fill_range(RngStream *s, int *out, int n, int min, int max);
+
+#endif
@@ -0,0 +1,107 @@
+#include <stdio.h>
+#include <string.h>
+#include "savestate.h"
+
+static uint64_t fnv(uint64_t h, uint64_t v)
+{
+    for (int i = 0; i < 8; i++) {
+        h ^= (v >> (8 * i)) & 0xFF;
+        h *= 0x100000001B3ull;
+    }
+    return h;
+}
+
+// any change to World's shape moves at least one of these
+uint64_t save_layout(void)
+{
+    const uint32_t order = 0x01020304;
+    const uint64_t parts[] = {
+        *(const uint8_t *) &order,
+        sizeof(World),
+        offsetof(World, game_state), offsetof(World, debug_mode), offsetof(World, params),
+        offsetof(World, player), offsetof(World, cannons), offsetof(World, bullets),
+        offsetof(World, crates), offsetof(World, planks), offsetof(World, boxes),
+        offsetof(World, crate_timer), offsetof(World, scroll), offsetof(World, rng),
+        sizeof(SimParams), sizeof(Player), sizeof(Cannons), sizeof(Bullets), sizeof(Crates),
+        sizeof(Planks), sizeof(PlayerCrate), sizeof(SimRng),
+        sizeof(EntityPool), sizeof(PoolOrder), sizeof(RngStream), sizeof(BulletHandler), sizeof(MovementHandler),
+        offsetof(Crates, x), offsetof(Crates, y), offsetof(PlayerCrate, x), offsetof(Bullets, x), offsetof(Planks, x),
+        MAX_CANNONS, MAX_BULLETS, MAX_CRATES, MAX_PLANKS, MAX_PLAYER_CRATES, POOL_MAX_CAPACITY,
+    };
+    uint64_t h = 0xCBF29CE484222325ull;
+    for (size_t i = 0; i < sizeof(parts) / sizeof(parts[0]); i++) h = fnv(h, parts[i]);
+    return h;
+}
+
+// word at a time so verifying a load costs about a microsecond, sim_checksum's byte
+// loop would be most of the load; World's size is a multiple of its 8 byte alignment
+static uint64_t world_hash(const World *w)
+{
+    const uint8_t *bytes = (const uint8_t *) w;
+    uint64_t h = 0x9E3779B97F4A7C15ull;
+    for (size_t i = 0; i < sizeof(World); i += 8) {
+        uint64_t v;
+        memcpy(&v, bytes + i, 8);
+        h = (h ^ v) * 0xFF51AFD7ED558CCDull;
+        h ^= h >> 32;
+    }
+    return h;
+}
+
+bool save_state_write(const char *path, const World *w, uint64_t ticks)
+{
+    SaveHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SAVE_MAGIC, 4);
+    header.version = SAVE_VERSION;
+    header.header_size = SAVE_HEADER_SIZE;
+    header.world_size = (uint32_t) sizeof(World);
+    header.tick_rate = SIM_TICK_RATE;
+    header.layout = save_layout();
+    header.checksum = world_hash(w);
+    header.ticks = ticks;
+
+    FILE *f = fopen(path, "wb");
+    if (!f) return false;
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1 && fwrite(w, sizeof(World), 1, f) == 1;
+    return (fclose(f) == 0) && ok;
+}
+
+static bool valid(const SaveMap *m)
+{
+    if (m->file.size != SAVE_HEADER_SIZE + sizeof(World)) return false;
+    const SaveHeader *h = m->header;
+    return memcmp(h->magic, SAVE_MAGIC, 4) == 0 && h->version == SAVE_VERSION &&
+        h->header_size == SAVE_HEADER_SIZE && h->world_size == sizeof(World) &&
+        h->tick_rate == SIM_TICK_RATE && h->layout == save_layout() &&
+        h->checksum == world_hash(m->world);
+}
+
+// m->world stays valid until save_state_unmap
+bool save_state_map(SaveMap *m, const char *path)
+{
+    memset(m, 0, sizeof(*m));
+    if (!file_map(&m->file, path)) return false;
+    m->header = m->file.base;
+    m->world = (const World *) ((const uint8_t *) m->file.base + SAVE_HEADER_SIZE);
+    if (valid(m)) return true;
+    save_state_unmap(m);
+    return false;
+}
+
+void save_state_unmap(SaveMap *m)
+{
+    file_unmap(&m->file);
+    m->header = NULL;
+    m->world = NULL;
+}
+
+bool save_state_load(const char *path, World *w, uint64_t *ticks)
+{
+    SaveMap m;
+    if (!save_state_map(&m, path)) return false;
+    *w = *m.world;
+    if (ticks) *ticks = m.header->ticks;
+    save_state_unmap(&m);
+    return true;
+}
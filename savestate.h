@@ -0,0 +1,44 @@
+#ifndef SAVESTATE_H
+#define SAVESTATE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "sim.h"
+#include "filemap.h"
+
+// save state file: a 64 byte header then the World exactly as it sits in memory.
+// the world holds no pointers, entities refer to each other by pool handle, so
+// the pointer fix-up on load is nothing at all: map the file and point at it.
+// the layout fingerprint covers field offsets and byte order, a file from a
+// build with a different World is refused instead of misread
+
+#define SAVE_MAGIC "20GS"
+#define SAVE_VERSION 1
+#define SAVE_HEADER_SIZE 64
+
+typedef struct save_header {
+    char magic[4];
+    uint16_t version;
+    uint16_t header_size;
+    uint32_t world_size;
+    uint32_t tick_rate;
+    uint64_t layout;
+    uint64_t checksum;          // word hash of the world bytes, cheaper than sim_checksum
+    uint64_t ticks;             // how far the run had got, for the caller's bookkeeping
+    uint8_t reserved[SAVE_HEADER_SIZE - 40];
+} SaveHeader;
+
+typedef struct save_map {
+    const SaveHeader *header;
+    const World *world;         // read only, straight out of the mapping
+    FileMap file;
+} SaveMap;
+
+uint64_t save_layout(void);
+bool save_state_write(const char *path, const World *w, uint64_t ticks);
+bool save_state_map(SaveMap *m, const char *path);
+void save_state_unmap(SaveMap *m);
+bool save_state_load(const char *path, World *w, uint64_t *ticks);
+
+#endif
@@ -0,0 +1,128 @@
+#include <stdio.h>
+#include "scene.h"
+#include "assets.h"
+#include "render.h"
+#include "profiler.h"
+
+static Vector2 interpolate(Vector2 prev, Vector2 curr, float alpha)
+{
+    return (Vector2) {
+        prev.x + (curr.x - prev.x) * alpha,
+        prev.y + (curr.y - prev.y) * alpha
+    };
+}
+
+void scene_draw(const Scene *s)
+{
+    const World *w = s->world;
+    const World *pw = s->prev;
+
+    // follows the sim scroll so crates stay put on the planks
+    float prev_scroll = pw->scroll;
+    if (prev_scroll > w->scroll) prev_scroll -= SCROLL_REBASE;
+    float scroll = prev_scroll + (w->scroll - prev_scroll) * s->alpha;
+
+    //::draw_watertiles::
+    PROFILE_SCOPE(ZONE_DRAW_WATERTILES) background_draw_water(s->background);
+    //::draw_scrolling_plank::
+    PROFILE_SCOPE(ZONE_DRAW_SCROLLING_PLANK) background_draw_plank(s->background, scroll);
+    //::draw_cannons::
+    PROFILE_SCOPE(ZONE_DRAW_CANNONS)
+    for (int i = 0; i < w->params.cannons; i++) {
+        if (w->cannons.health[i] <= 0) continue;
+        Color health = (w->cannons.health[i] == 2) ? WHITE : RED; 
+        Vector2 can_pos = interpolate((Vector2) {pw->cannons.x[i], pw->cannons.y[i]}, (Vector2) {w->cannons.x[i], w->cannons.y[i]}, s->alpha);
+        Rectangle source = sprite_regions[SPRITE_CANNON];
+        if (!cannon_on_left(&w->cannons, i)) source.width = -source.width;
+        render_texture(LAYER_CANNONS, s->spritesheet,
+            source,
+            (Rectangle) {can_pos.x, can_pos.y, CANNON_SIZE, CANNON_SIZE},
+            (Vector2) {16,16}, health
+         );
+    }
+    //::draw_bullets::
+    PROFILE_SCOPE(ZONE_DRAW_BULLETS)
+    {
+        for (int i = 0; i < w->params.cannons; i++) {
+            bool cannon_alive = w->cannons.health[i] > 0;
+            BulletHandler b = w->cannons.bullet[i];
+            if (b.state == LOCKING_ON && cannon_alive) {
+                Vector2 can_pos = interpolate((Vector2) {pw->cannons.x[i], pw->cannons.y[i]}, (Vector2) {w->cannons.x[i], w->cannons.y[i]}, s->alpha);
+                render_line(LAYER_LOCK_ON, can_pos, b.lock_on, 2.0f, C_GREY);
+            }
+        }
+        const Bullets *bullets = &w->bullets;
+        const Bullets *prev = &pw->bullets;
+        for (int i = 0; i < bullets->pool.count; i++) {
+            Vector2 pos = {bullets->x[i], bullets->y[i]};
+            int j = pool_index(&prev->pool, bullets->pool.handles[i]);
+            if (j >= 0 && prev->state[j] == bullets->state[i]) pos = interpolate((Vector2) {prev->x[j], prev->y[j]}, pos, s->alpha);
+            render_texture(LAYER_BULLETS, s->spritesheet,
+                sprite_regions[SPRITE_BULLET],
+                (Rectangle){pos.x,pos.y,32,32},
+                (Vector2){4,4}, WHITE
+             );
+        }
+    }
+    //::draw_crates::
+    PROFILE_SCOPE(ZONE_DRAW_CRATES)
+    for (int i = 0; i < w->crates.pool.count; i++) {
+        const Crates *prev = &pw->crates;
+        int handle = w->crates.pool.handles[i];
+        Vector2 pos = {w->crates.x[i], w->crates.y[i] + w->scroll};
+        int j = pool_index(&prev->pool, handle);
+        if (j >= 0) pos = interpolate((Vector2) {prev->x[j], prev->y[j] + pw->scroll}, pos, s->alpha);
+        Rectangle crate_rec = (Rectangle) {pos.x, pos.y, CRATE_SIZE, CRATE_SIZE};    
+        render_rect(LAYER_GROUND, crate_rec, C_BROWN);
+        if (handle == w->crates.selected) {
+            render_rect_lines(LAYER_GROUND, crate_rec, 2, YELLOW);
+        }    
+    }
+    //::draw_boxes::
+    PROFILE_SCOPE(ZONE_DRAW_BOXES)
+    for (int i = 0; i < w->boxes.pool.count; i++) {
+        const PlayerCrate *prev = &pw->boxes;
+        Vector2 pos = {w->boxes.x[i], w->boxes.y[i] + w->scroll};
+        int j = pool_index(&prev->pool, w->boxes.pool.handles[i]);
+        if (j >= 0) pos = interpolate((Vector2) {prev->x[j], prev->y[j] + pw->scroll}, pos, s->alpha);
+        Rectangle box_rec = (Rectangle) {pos.x, pos.y, CRATE_SIZE, CRATE_SIZE};
+        render_rect(LAYER_GROUND, box_rec, C_BLUE);
+    }
+    //::draw_planks::
+    PROFILE_SCOPE(ZONE_DRAW_PLANKS)
+    for (int i = 0; i < w->planks.pool.count; i++) {
+        const Planks *prev = &pw->planks;
+        Vector2 pos = {w->planks.x[i], w->planks.y[i]};
+        int j = pool_index(&prev->pool, w->planks.pool.handles[i]);
+        if (j >= 0) pos = interpolate((Vector2) {prev->x[j], prev->y[j]}, pos, s->alpha);
+        Rectangle plank_drop = (Rectangle) {pos.x, pos.y, PLANK_DROP_SIZE, PLANK_DROP_SIZE};
+        render_rect(LAYER_DROPS, plank_drop, WHITE);
+    }
+    
+    //::draw_player::
+    PROFILE_SCOPE(ZONE_DRAW_PLAYER)
+    {
+        Rectangle player_rec = w->player.dest_rect;
+        Vector2 pos = interpolate(
+            (Vector2) {pw->player.dest_rect.x, pw->player.dest_rect.y},
+            (Vector2) {player_rec.x, player_rec.y}, s->alpha
+        );
+        player_rec.x = pos.x;
+        player_rec.y = pos.y;
+        render_texture(LAYER_PLAYER, s->spritesheet, w->player.source_rect, player_rec, (Vector2) {0,0}, WHITE);
+    }
+    if (s->debug) render_rect(LAYER_DEBUG, w->player.colliders[TOP], (Color) {255,0,0,100});
+
+    //::draw_score::
+    PROFILE_SCOPE(ZONE_DRAW_SCORE)
+    {
+        render_rect(LAYER_HUD, (Rectangle) {(int) (GAME_WIDTH * 0.065f), 0, 32, 32}, C_BROWN);
+        char score[16];
+        snprintf(score, sizeof(score), "x %d", w->player.inventory);
+        render_text(LAYER_HUD, score, GAME_WIDTH * 0.1f, 0,  35, WHITE);
+        //::draw_main_menu::
+        if (w->game_state == MAIN_MENU) {
+            render_text(LAYER_HUD, "Press Space to play", GAME_WIDTH*0.5f, GAME_HEIGHT*0.5f, 22, C_BLACK);
+        }
+    }
+}
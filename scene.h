@@ -0,0 +1,28 @@
+#ifndef SCENE_H
+#define SCENE_H
+
+#include <stdbool.h>
+#include "raylib.h"
+#include "sim.h"
+#include "background.h"
+
+#define C_BROWN (Color) {64,  53,  33,  255}
+#define C_BLUE  (Color) {70,  126, 115, 255}
+#define C_BLACK (Color) {1,   20,  26,  255}
+#define C_RED   (Color) {112, 58,  40,  255}
+#define C_GREY  (Color) {147, 163, 153, 255}
+
+// everything the game world puts on screen, drawn between two sim states
+// only talks to the render queue, so any render backend can show it
+typedef struct scene {
+    const World *world;
+    const World *prev;
+    float alpha;
+    Texture2D spritesheet;
+    const Background *background;
+    bool debug;
+} Scene;
+
+void scene_draw(const Scene *s);
+
+#endif
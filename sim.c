@@ -0,0 +1,987 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "sim.h"
+#include "profiler.h"
+#include "simd.h"
+#define RAYMATH_STATIC_INLINE
+#include "raymath.h"
+
+// reversed shots chase a point this far along their direction, always past the screen edge
+#define REVERSE_REACH (GAME_WIDTH + GAME_HEIGHT)
+
+#define CRATE_BOUNDS(px, py) ((Rectangle) {(px), (py), CRATE_SIZE, CRATE_SIZE})
+#define CANNON_BOUNDS(px, py) ((Rectangle) {(px), (py), CANNON_SIZE, CANNON_SIZE})
+
+// this thread's copy, kept up to date by the updates for the world it was last synced to
+static __thread SpatialGrid grid;
+static __thread const World *grid_world;
+
+const Rectangle plank_rect = {
+    GAME_WIDTH * 0.5f - (PLANK_W * 0.5f),
+    0,
+    PLANK_W,
+    GAME_HEIGHT
+};
+
+const SimParams sim_default_params = {
+    .crate_chance = 15,
+    .fire_odds = 10,
+    .bullet_speed = 200,
+    .damaged_bullet_speed = 300,
+    .box_cost = BOX_COST,
+    .cannons = 6,
+    .crates = 5,
+    .planks = 10,
+    .boxes = 20,
+    .cannon_layout = CANNON_LAYOUT_SIDES,
+};
+
+static int clamp_limit(int v, int ceiling)
+{
+    if (v < 0) return 0;
+    return (v > ceiling) ? ceiling : v;
+}
+
+void sim_init(World *w, uint64_t seed)
+{
+    sim_init_params(w, seed, &sim_default_params);
+}
+
+void sim_init_params(World *w, uint64_t seed, const SimParams *params)
+{
+    simd_init();
+    // zero padding too so sim_checksum only depends on simulated state
+    memset(w, 0, sizeof(*w));
+    w->params = *params;
+    w->params.cannons = clamp_limit(params->cannons, MAX_CANNONS);
+    w->params.crates = clamp_limit(params->crates, MAX_CRATES);
+    w->params.planks = clamp_limit(params->planks, MAX_PLANKS);
+    w->params.boxes = clamp_limit(params->boxes, MAX_PLAYER_CRATES);
+    // rng_range swaps reversed bounds, fire_odds under 1 would lock every idle cannon on every tick
+    if (params->fire_odds < 1) w->params.fire_odds = 1;
+    w->params.crate_chance = clamp_limit(params->crate_chance, 100);
+    if (params->bullet_speed < 1) w->params.bullet_speed = 1;
+    if (params->damaged_bullet_speed < 1) w->params.damaged_bullet_speed = 1;
+    if (params->cannon_layout < 0 || params->cannon_layout >= CANNON_LAYOUT_COUNT) w->params.cannon_layout = CANNON_LAYOUT_SIDES;
+    sim_seed_rng(&w->rng, seed);
+    w->game_state = IN_GAME;
+    reset_game(w);
+}
+
+void sim_step(World *w, SimInput input, float dt)
+{
+    w->debug_mode = input.debug;
+    if (w != grid_world) sim_sync_grid(w);
+
+    if (!w->player.alive) w->game_state = RESET_STATE;
+
+    if (w->game_state != MAIN_MENU) {
+        PROFILE_SCOPE(ZONE_UPDATE_PLAYER) update_player(w, input, dt);
+        PROFILE_SCOPE(ZONE_UPDATE_CANNONS) update_cannons(w, dt);
+        Contacts contacts;
+        PROFILE_SCOPE(ZONE_COLLIDE_DETECT) collect_contacts(w, &contacts);
+        PROFILE_SCOPE(ZONE_COLLIDE_RESOLVE) resolve_contacts(w, &contacts, input);
+        PROFILE_SCOPE(ZONE_UPDATE_CRATES) update_crates(w, dt);
+        PROFILE_SCOPE(ZONE_UPDATE_BOXES) update_boxes(w, dt);
+        PROFILE_SCOPE(ZONE_UPDATE_PLANKS) update_planks(w, dt);
+    }
+    if (w->game_state == RESET_STATE) {
+        reset_game(w);
+        w->game_state = MAIN_MENU;
+    }
+    if (w->game_state == MAIN_MENU) {
+        if (input.space_pressed) {
+            w->game_state = IN_GAME;
+        }
+    }
+    update_scroll(w, dt);
+}
+
+void sim_seed_rng(SimRng *rng, uint64_t seed)
+{
+    rng->seed = seed;
+    for (int i = 0; i < MAX_CANNONS; i++) {
+        rng->cannon_move[i] = rng_stream(seed, RNG_STREAM_ID(RNG_CANNON_MOVE, i));
+        rng->cannon_fire[i] = rng_stream(seed, RNG_STREAM_ID(RNG_CANNON_FIRE, i));
+    }
+    rng->crate_spawn = rng_stream(seed, RNG_STREAM_ID(RNG_CRATE_SPAWN, 0));
+    rng->plank_jitter = rng_stream(seed, RNG_STREAM_ID(RNG_PLANK_JITTER, 0));
+}
+
+// fnv-1a over the raw world, for comparing runs
+uint64_t sim_checksum(const World *w)
+{
+    const uint8_t *bytes = (const uint8_t *) w;
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for (size_t i = 0; i < sizeof(*w); i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001B3ull;
+    }
+    return hash;
+}
+
+bool check_collision_recs(Rectangle a, Rectangle b)
+{
+    return (a.x < b.x + b.width && a.x + a.width > b.x) &&
+           (a.y < b.y + b.height && a.y + a.height > b.y);
+}
+
+bool check_collision_circle_rec(Vector2 center, float radius, Rectangle rec)
+{
+    float half_w = 0.5f * rec.width;
+    float half_h = 0.5f * rec.height;
+    float dx = fabsf(center.x - (rec.x + half_w));
+    float dy = fabsf(center.y - (rec.y + half_h));
+
+    if (dx > half_w + radius || dy > half_h + radius) return false;
+    if (dx <= half_w || dy <= half_h) return true;
+
+    float cx = dx - half_w;
+    float cy = dy - half_h;
+    return (cx * cx + cy * cy) <= radius * radius;
+}
+
+// clips [t0, t1] to the part of p + d * t that lies in [lo, hi]
+static bool clip_slab(float p, float d, float lo, float hi, float *t0, float *t1)
+{
+    if (d == 0.0f) return p >= lo && p <= hi;
+    float a = (lo - p) / d;
+    float b = (hi - p) / d;
+    if (a > b) {
+        float swap = a;
+        a = b;
+        b = swap;
+    }
+    if (a > *t0) *t0 = a;
+    if (b < *t1) *t1 = b;
+    return *t0 <= *t1;
+}
+
+// earliest fraction of the move from `from` to `to` at which the circle touches rec, -1 for
+// a miss. the centre's path is a ray against rec grown by the radius with rounded corners:
+// entering the grown rect beside a face is the hit, entering near a corner has to reach
+// the rounding too. a circle that ends up touching always hits, whatever the rounding
+float sweep_circle_rec(Vector2 from, Vector2 to, float radius, Rectangle rec)
+{
+    float dx = to.x - from.x;
+    float dy = to.y - from.y;
+    float t0 = 0.0f, t1 = 1.0f;
+    if (!clip_slab(from.x, dx, rec.x - radius, rec.x + rec.width + radius, &t0, &t1)) return -1.0f;
+    if (!clip_slab(from.y, dy, rec.y - radius, rec.y + rec.height + radius, &t0, &t1)) return -1.0f;
+    if (check_collision_circle_rec(from, radius, rec)) return 0.0f;
+
+    float hx = from.x + dx * t0;
+    float hy = from.y + dy * t0;
+    float cx = fminf(fmaxf(hx, rec.x), rec.x + rec.width);
+    float cy = fminf(fmaxf(hy, rec.y), rec.y + rec.height);
+    if (cx == hx || cy == hy) return t0;
+
+    // |from + d t - corner| = radius, the smaller root
+    float ox = from.x - cx;
+    float oy = from.y - cy;
+    float a = dx * dx + dy * dy;
+    float b = ox * dx + oy * dy;
+    float c = ox * ox + oy * oy - radius * radius;
+    float disc = b * b - a * c;
+    float t = (disc >= 0.0f) ? (-b - sqrtf(disc)) / a : 2.0f;
+    if (t <= 1.0f) return fmaxf(t, t0);
+    return check_collision_circle_rec(to, radius, rec) ? 1.0f : -1.0f;
+}
+
+const SpatialGrid *sim_grid(void)
+{
+    return &grid;
+}
+
+// cannons have no pool, their slot is the cannon id
+void sim_build_grid(const World *w, SpatialGrid *g)
+{
+    const Crates *crates = &w->crates;
+    grid_clear(g, GRID_CRATES);
+    for (int i = 0; i < crates->pool.count; i++) {
+        grid_insert(g, GRID_CRATES, crates->pool.handles[i] & POOL_SLOT_MASK, CRATE_BOUNDS(crates->x[i], crates->y[i]));
+    }
+
+    const PlayerCrate *boxes = &w->boxes;
+    grid_clear(g, GRID_BOXES);
+    for (int i = 0; i < boxes->pool.count; i++) {
+        grid_insert(g, GRID_BOXES, boxes->pool.handles[i] & POOL_SLOT_MASK, CRATE_BOUNDS(boxes->x[i], boxes->y[i]));
+    }
+
+    const Cannons *cannons = &w->cannons;
+    grid_clear(g, GRID_CANNONS);
+    for (int i = 0; i < w->params.cannons; i++) {
+        if (cannons->health[i] > 0) grid_insert(g, GRID_CANNONS, i, CANNON_BOUNDS(cannons->x[i], cannons->y[i]));
+    }
+}
+
+void sim_sync_grid(const World *w)
+{
+    sim_build_grid(w, &grid);
+    grid_world = w;
+}
+
+// the updates keep the grid and y orders in step with every spawn, move and
+// despawn; this is only needed after placing entities by hand or moving them
+// all at once
+void sim_rebuild_spatial(World *w)
+{
+    Crates *crates = &w->crates;
+    crates->by_y.count = 0;
+    for (int i = 0; i < crates->pool.count; i++) {
+        pool_order_insert(&crates->by_y, &crates->pool, crates->y, crates->pool.handles[i]);
+    }
+
+    PlayerCrate *boxes = &w->boxes;
+    boxes->by_y.count = 0;
+    for (int i = 0; i < boxes->pool.count; i++) {
+        pool_order_insert(&boxes->by_y, &boxes->pool, boxes->y, boxes->pool.handles[i]);
+    }
+    sim_sync_grid(w);
+}
+
+typedef struct sweep_hit {
+    int index;                  // dense index, -1 for none
+    float time;                 // fraction of this tick's move
+} SweepHit;
+
+// earliest candidate square the bullet's move from `from` to `to` touches, ties go to the
+// lower dense index; one already touched at the start wins without sweeping the rest
+// candidates come out of the crate, box or cannon pool, the largest bounds them
+#define SWEEP_MAX_A (MAX_CRATES > MAX_PLAYER_CRATES ? MAX_CRATES : MAX_PLAYER_CRATES)
+#define SWEEP_MAX_CANDIDATES (SWEEP_MAX_A > MAX_CANNONS ? SWEEP_MAX_A : MAX_CANNONS)
+
+// gathered candidates, per thread rather than on the stack: raised ceilings make it tens
+// of kilobytes, and the bot and vec workers step worlds too
+typedef struct sweep_scratch {
+    float x[SWEEP_MAX_CANDIDATES];
+    float y[SWEEP_MAX_CANDIDATES];
+    int index[SWEEP_MAX_CANDIDATES];
+} SweepScratch;
+
+static __thread SweepScratch sweep_scratch;
+
+static SweepHit bullet_first_hit(Vector2 from, Vector2 to, const float *x, const float *y, float size, GridMask candidates)
+{
+    float *near_x = sweep_scratch.x, *near_y = sweep_scratch.y;
+    int *index = sweep_scratch.index;
+    int n = 0;
+    for (int i = grid_mask_pop(&candidates); i >= 0; i = grid_mask_pop(&candidates)) {
+        near_x[n] = x[i];
+        near_y[n] = y[i];
+        index[n++] = i;
+    }
+    if (n == 0) return (SweepHit) {-1, 2.0f};
+    int hit = simd.circle_rect_first(from.x, from.y, BULLET_RADIUS, near_x, near_y, size, size, n);
+    if (hit >= 0) return (SweepHit) {index[hit], 0.0f};
+
+    SweepHit first = {-1, 2.0f};
+    for (int k = 0; k < n; k++) {
+        float t = sweep_circle_rec(from, to, BULLET_RADIUS, (Rectangle) {near_x[k], near_y[k], size, size});
+        if (t >= 0.0f && t < first.time) first = (SweepHit) {index[k], t};
+    }
+    return first;
+}
+
+// everything the bullet covers on its way from `from` to `to`
+static Rectangle bullet_bounds(Vector2 from, Vector2 to)
+{
+    float x0 = fminf(from.x, to.x), y0 = fminf(from.y, to.y);
+    float x1 = fmaxf(from.x, to.x), y1 = fmaxf(from.y, to.y);
+    return (Rectangle) {x0 - BULLET_RADIUS, y0 - BULLET_RADIUS, x1 - x0 + 2 * BULLET_RADIUS, y1 - y0 + 2 * BULLET_RADIUS};
+}
+
+// half the cannons, rounded up, go down the left edge; columns of up to three keep
+// the shipped 250px spacing and longer ones squeeze into the same 500px
+static Vector2 cannon_position(CannonLayout layout, int i, int count)
+{
+    if (layout == CANNON_LAYOUT_RING) {
+        float angle = 2.0f * PI * i / count;
+        return (Vector2) {
+            0.5f * (GAME_WIDTH - CANNON_SIZE) + 0.4f * GAME_WIDTH * cosf(angle),
+            0.5f * (GAME_HEIGHT - CANNON_SIZE) + 0.4f * GAME_HEIGHT * sinf(angle),
+        };
+    }
+    int left = (count + 1) / 2;
+    bool on_left = i < left;
+    int column = on_left ? left : count - left;
+    int row = on_left ? i : i - left;
+    float step = (column > 1) ? fminf(250.0f, 500.0f / (column - 1)) : 0.0f;
+    return (Vector2) {on_left ? 100.0f : 1100.0f, 100.0f + step * row};
+}
+
+void reset_game(World *w) {
+    w->player.dest_rect = (Rectangle) {
+        GAME_WIDTH * 0.5f - (PLAYER_SIZE * 0.5f),
+        GAME_HEIGHT - PLAYER_SIZE,
+        PLAYER_SIZE,
+        PLAYER_SIZE
+    };
+    
+    w->player.source_rect.width = w->player.source_rect.height = PLAYER_SPRITE_SIZE;
+    w->player.source_rect.y = 32; 
+    w->player.position.x = 0;
+    w->player.position.y = 0;
+    w->player.color = (Color) {255, 255, 255, 255};
+    w->player.alive = true;
+    w->player.animation = (AnimationHandler) {
+        .num_frames = 2,
+        .timer = 0.0f,
+        .current_frame = 0,
+        .anim_speed = 0.15f,
+    };
+    w->player.direction = TOP;
+    w->player.colliders[TOP] = (Rectangle) {0, 0, 0.5 *  PLAYER_SIZE, 0.5 *  PLAYER_SIZE};
+    w->player.inventory = (w->debug_mode) ? 100 : 0;
+
+    for (int i = 0; i < w->params.cannons; i++) {
+        Vector2 at = cannon_position(w->params.cannon_layout, i, w->params.cannons);
+        float x = at.x, y = at.y;
+        w->cannons.x[i] = x;
+        w->cannons.y[i] = y;
+        w->cannons.bullet[i] = (BulletHandler) {
+            .bullet_position = {0,0},
+            .lock_on = {0,0},
+            .timer = 0.0f,
+            .state = IDLE,
+            .speed = w->params.bullet_speed,
+            .bullet = POOL_NO_HANDLE,
+        };
+        w->cannons.movement[i] = (MovementHandler) {
+            .centre_pos = (Vector2) {x, y},
+            .target_pos = (Vector2) {x, y},
+            .timer = 0.0f,
+            .state = STATIONARY
+        };
+        w->cannons.health[i] = 2;
+    }
+
+    pool_init(&w->bullets.pool, w->params.cannons);
+
+    pool_init(&w->crates.pool, w->params.crates);
+    w->crates.selected = POOL_NO_HANDLE;
+
+    pool_init(&w->planks.pool, w->params.planks);
+    pool_init(&w->boxes.pool, w->params.boxes);
+    sim_rebuild_spatial(w);
+    
+    return;
+}
+
+// a plank dropped while every slot is busy is lost, same as the old overwrite of slot 0
+void spawn_plank(World *w, Vector2 crate_pos) {
+    Planks *planks = &w->planks;
+    int i = pool_spawn(&planks->pool);
+    if (i < 0) return;
+
+    planks->x[i] = crate_pos.x + 0.5f * CRATE_SIZE;
+    planks->y[i] = crate_pos.y + 0.5f * CRATE_SIZE;
+    planks->target_x[i] = 0;
+    planks->target_y[i] = 0;
+    planks->timer[i] = 0.0f;
+    planks->state[i] = SPAWN;
+}
+
+// pos is in screen space
+void spawn_crate(World *w, Vector2 pos) {
+    Crates *crates = &w->crates;
+    int i = pool_spawn(&crates->pool);
+    if (i < 0) return;
+
+    crates->x[i] = pos.x;
+    crates->y[i] = pos.y - w->scroll;
+    grid_insert(&grid, GRID_CRATES, crates->pool.handles[i] & POOL_SLOT_MASK, CRATE_BOUNDS(crates->x[i], crates->y[i]));
+    pool_order_insert(&crates->by_y, &crates->pool, crates->y, crates->pool.handles[i]);
+}
+
+// pos is in screen space
+void spawn_box(World *w, Vector2 pos) {
+    PlayerCrate *boxes = &w->boxes;
+    int i = pool_spawn(&boxes->pool);
+    if (i < 0) return;
+
+    boxes->x[i] = pos.x;
+    boxes->y[i] = pos.y - w->scroll;
+    grid_insert(&grid, GRID_BOXES, boxes->pool.handles[i] & POOL_SLOT_MASK, CRATE_BOUNDS(boxes->x[i], boxes->y[i]));
+    pool_order_insert(&boxes->by_y, &boxes->pool, boxes->y, boxes->pool.handles[i]);
+}
+
+void despawn_bullet(World *w, int index) {
+    Bullets *b = &w->bullets;
+    BulletHandler *owner = &w->cannons.bullet[b->owner[index]];
+    if (owner->bullet == b->pool.handles[index]) owner->bullet = POOL_NO_HANDLE;
+
+    int last = pool_despawn(&b->pool, index);
+    if (last == index) return;
+    b->x[index] = b->x[last];
+    b->y[index] = b->y[last];
+    b->from_x[index] = b->from_x[last];
+    b->from_y[index] = b->from_y[last];
+    b->target_x[index] = b->target_x[last];
+    b->target_y[index] = b->target_y[last];
+    b->speed[index] = b->speed[last];
+    b->state[index] = b->state[last];
+    b->owner[index] = b->owner[last];
+}
+
+void despawn_crate(World *w, int index) {
+    Crates *crates = &w->crates;
+    if (crates->pool.handles[index] == crates->selected) crates->selected = POOL_NO_HANDLE;
+    grid_remove(&grid, GRID_CRATES, crates->pool.handles[index] & POOL_SLOT_MASK, CRATE_BOUNDS(crates->x[index], crates->y[index]));
+    pool_order_remove(&crates->by_y, crates->pool.handles[index]);
+
+    int last = pool_despawn(&crates->pool, index);
+    if (last == index) return;
+    crates->x[index] = crates->x[last];
+    crates->y[index] = crates->y[last];
+}
+
+void despawn_plank(Planks *planks, int index) {
+    int last = pool_despawn(&planks->pool, index);
+    if (last == index) return;
+    planks->x[index] = planks->x[last];
+    planks->y[index] = planks->y[last];
+    planks->target_x[index] = planks->target_x[last];
+    planks->target_y[index] = planks->target_y[last];
+    planks->timer[index] = planks->timer[last];
+    planks->state[index] = planks->state[last];
+}
+
+void despawn_box(World *w, int index) {
+    PlayerCrate *boxes = &w->boxes;
+    grid_remove(&grid, GRID_BOXES, boxes->pool.handles[index] & POOL_SLOT_MASK, CRATE_BOUNDS(boxes->x[index], boxes->y[index]));
+    pool_order_remove(&boxes->by_y, boxes->pool.handles[index]);
+    int last = pool_despawn(&boxes->pool, index);
+    if (last == index) return;
+    boxes->x[index] = boxes->x[last];
+    boxes->y[index] = boxes->y[last];
+}
+
+void bump_collision(Player *p, Rectangle obstacle) {
+    Rectangle p_col = p->colliders[TOP];
+    int overlap_x = 0, overlap_y = 0;
+    int x_sign = 1, y_sign = 1;
+    
+    if (p_col.x < obstacle.x) {
+        overlap_x = (p_col.x + p_col.width) - obstacle.x;
+        x_sign = -1; 
+    } else {
+        overlap_x = obstacle.x + obstacle.width - p_col.x;
+    }
+
+    if (p_col.y < obstacle.y) {
+        overlap_y = (p_col.y + p_col.height) - obstacle.y;
+        y_sign = -1;
+    } else {
+        overlap_y = obstacle.y + obstacle.height - p_col.y;
+    }
+
+    if (abs(overlap_x) < abs(overlap_y)) {
+        p->dest_rect.x += x_sign * overlap_x;
+    } else {
+        p->dest_rect.y += y_sign * overlap_y;
+    }
+}
+
+void update_player(World *w, SimInput input, float dt)
+{   
+    w->player.position.x = 0;
+    w->player.position.y = 0;
+
+    if (input.up) {
+        w->player.direction = TOP;
+        w->player.position.y = -100 * dt;
+    }
+    if (input.down) {
+        w->player.direction = BOTTOM;
+        w->player.position.y = 150 * dt;
+    }
+    if (input.left) {
+        w->player.direction = LEFT;
+        w->player.position.x = -100 * dt;
+    }
+    if (input.right) {
+        w->player.direction = RIGHT;
+        w->player.position.x = 100 * dt;
+    }
+
+    Rectangle next_position = w->player.dest_rect;
+    next_position.x += w->player.position.x;
+    next_position.y += w->player.position.y;
+     
+    w->player.colliders[TOP].y = next_position.y + 0.5f * PLAYER_SIZE - 0.6f * w->player.colliders[TOP].height;
+    w->player.colliders[TOP].x = next_position.x + 0.5f * PLAYER_SIZE - 0.5f * w->player.colliders[TOP].width;    
+
+    if (next_position.y + PLAYER_SIZE > GAME_HEIGHT) next_position.y = GAME_HEIGHT - PLAYER_SIZE;
+    if (next_position.x + (0.5f * PLAYER_SIZE) < plank_rect.x || next_position.x + 0.5f * PLAYER_SIZE > plank_rect.x + PLANK_W) {
+        w->player.alive = false;
+        w->player.color = (Color) {220, 100, 100 , 255};
+    }
+
+    w->player.dest_rect.x = next_position.x;
+    w->player.dest_rect.y = next_position.y;
+    
+    //::player_animation::
+    {
+        bool moving = (w->player.position.x != 0.0f || w->player.position.y != 0.0f);
+        if (moving) {
+            w->player.animation.timer += dt;
+            if (w->player.animation.timer > w->player.animation.anim_speed) {
+                w->player.animation.current_frame += 1;
+                w->player.animation.timer = 0.0f;
+                if (w->player.animation.current_frame == w->player.animation.num_frames) {
+                    w->player.animation.current_frame = 0;
+                }
+            }     
+        } else {
+            w->player.animation.current_frame = 0;
+        }
+        w->player.source_rect.x = w->player.animation.current_frame * PLAYER_SPRITE_SIZE;
+        if (w->player.position.y < 0) w->player.source_rect.y = 1 * PLAYER_SPRITE_SIZE;
+        else if (w->player.position.y > 0) w->player.source_rect.y = 0 * PLAYER_SPRITE_SIZE;
+    }
+}
+
+static void push_contact(Contacts *contacts, ContactKind kind, int bullet, int other, float time)
+{
+    if (contacts->count >= MAX_CONTACTS) return;
+    contacts->items[contacts->count++] = (Contact) {kind, bullet, other, time};
+}
+
+// read only pass over the world, player pairs first then each bullet in pool order
+void collect_contacts(const World *w, Contacts *contacts)
+{
+    const Crates *crates = &w->crates;
+    const PlayerCrate *boxes = &w->boxes;
+    const Bullets *bullets = &w->bullets;
+    contacts->count = 0;
+
+    //::player_contacts:: crates and boxes are matched in world space
+    Rectangle player_col = w->player.colliders[TOP];
+    player_col.y -= w->scroll;
+    GridMask near = grid_dense(&crates->pool, grid_query(&grid, GRID_CRATES, player_col));
+    for (int i = grid_mask_pop(&near); i >= 0; i = grid_mask_pop(&near)) {
+        if (check_collision_recs(player_col, CRATE_BOUNDS(crates->x[i], crates->y[i]))) {
+            push_contact(contacts, CONTACT_PLAYER_CRATE, POOL_NO_HANDLE, crates->pool.handles[i], 0.0f);
+        }
+    }
+    near = grid_dense(&boxes->pool, grid_query(&grid, GRID_BOXES, player_col));
+    for (int i = grid_mask_pop(&near); i >= 0; i = grid_mask_pop(&near)) {
+        if (check_collision_recs(player_col, CRATE_BOUNDS(boxes->x[i], boxes->y[i]))) {
+            push_contact(contacts, CONTACT_PLAYER_BOX, POOL_NO_HANDLE, boxes->pool.handles[i], 0.0f);
+        }
+    }
+
+    //::bullet_contacts:: a firing shot reports only its earliest hit along this tick's move,
+    // ties go player before crates before boxes
+    for (int n = 0; n < bullets->pool.count; n++) {
+        int handle = bullets->pool.handles[n];
+        Vector2 from = {bullets->from_x[n], bullets->from_y[n]};
+        Vector2 pos = {bullets->x[n], bullets->y[n]};
+        if (bullets->state[n] == FIRING) {
+            Vector2 target = {bullets->target_x[n], bullets->target_y[n]};
+            ContactKind kind = CONTACT_BULLET_SPENT;
+            int other = POOL_NO_HANDLE;
+            float time = sweep_circle_rec(from, pos, BULLET_RADIUS, w->player.dest_rect);
+            if (time >= 0.0f) kind = CONTACT_BULLET_PLAYER;
+            else time = 2.0f;
+
+            Vector2 world_from = {from.x, from.y - w->scroll};
+            Vector2 world_pos = {pos.x, pos.y - w->scroll};
+            Rectangle reach = bullet_bounds(world_from, world_pos);
+            SweepHit hit = bullet_first_hit(world_from, world_pos, crates->x, crates->y, CRATE_SIZE,
+                grid_dense(&crates->pool, grid_query(&grid, GRID_CRATES, reach)));
+            if (hit.index >= 0 && hit.time < time) {
+                kind = CONTACT_BULLET_CRATE;
+                other = crates->pool.handles[hit.index];
+                time = hit.time;
+            }
+            hit = bullet_first_hit(world_from, world_pos, boxes->x, boxes->y, CRATE_SIZE,
+                grid_dense(&boxes->pool, grid_query(&grid, GRID_BOXES, reach)));
+            if (hit.index >= 0 && hit.time < time) {
+                kind = CONTACT_BULLET_BOX;
+                other = boxes->pool.handles[hit.index];
+                time = hit.time;
+            }
+            if (time <= 1.0f) push_contact(contacts, kind, handle, other, time);
+            else if (Vector2Equals(pos, target)) push_contact(contacts, CONTACT_BULLET_SPENT, handle, POOL_NO_HANDLE, 1.0f);
+        } else if (bullets->state[n] == REVERSE) {
+            SweepHit hit = bullet_first_hit(from, pos, w->cannons.x, w->cannons.y, CANNON_SIZE,
+                grid_query(&grid, GRID_CANNONS, bullet_bounds(from, pos)));
+            if (hit.index >= 0) push_contact(contacts, CONTACT_BULLET_CANNON, handle, hit.index, hit.time);
+            if (pos.x < 0 || pos.x > GAME_WIDTH || pos.y > GAME_HEIGHT || pos.y < 0) {
+                push_contact(contacts, CONTACT_BULLET_SPENT, handle, POOL_NO_HANDLE, 1.0f);
+            }
+        }
+    }
+}
+
+// the selection sticks while its crate is touched, otherwise the first touched crate takes it
+static void resolve_crate_contacts(World *w, const Contacts *contacts)
+{
+    Crates *crates = &w->crates;
+    bool selected_touched = false;
+    for (int n = 0; n < contacts->count; n++) {
+        const Contact *c = &contacts->items[n];
+        if (c->kind == CONTACT_PLAYER_CRATE && c->other == crates->selected) selected_touched = true;
+    }
+    if (!selected_touched) crates->selected = POOL_NO_HANDLE;
+
+    for (int n = 0; n < contacts->count; n++) {
+        const Contact *c = &contacts->items[n];
+        if (c->kind != CONTACT_PLAYER_CRATE) continue;
+        int i = pool_index(&crates->pool, c->other);
+        if (crates->selected == POOL_NO_HANDLE) crates->selected = c->other;
+        bump_collision(&w->player, CRATE_BOUNDS(crates->x[i], crates->y[i] + w->scroll));
+    }
+}
+
+// boxes sit flush against each other, pushing out of more than one overshoots
+static void resolve_box_contacts(World *w, const Contacts *contacts)
+{
+    PlayerCrate *boxes = &w->boxes;
+    for (int n = 0; n < contacts->count; n++) {
+        const Contact *c = &contacts->items[n];
+        if (c->kind != CONTACT_PLAYER_BOX) continue;
+        int i = pool_index(&boxes->pool, c->other);
+        bump_collision(&w->player, CRATE_BOUNDS(boxes->x[i], boxes->y[i] + w->scroll));
+        return;
+    }
+}
+
+// each press breaks the selected crate, or places a box when nothing is selected.
+// presses reach the sim at most one per tick, so a held or bouncing key can't
+// break more than the one crate
+static void resolve_player_action(World *w, SimInput input)
+{
+    if (!input.space_pressed) return;
+    Crates *crates = &w->crates;
+    int selected = pool_index(&crates->pool, crates->selected);
+    if (selected >= 0) {
+        spawn_plank(w, (Vector2) {crates->x[selected], crates->y[selected] + w->scroll});
+        despawn_crate(w, selected);
+        return;
+    }
+    if (pool_full(&w->boxes.pool) || w->player.inventory < w->params.box_cost) return;
+
+    float pY = w->player.dest_rect.y;
+    float pX = w->player.dest_rect.x;
+    Vector2 placement = {0,0};
+    switch (w->player.direction) {
+        case TOP:
+            placement.x = pX;
+            placement.y = pY - CRATE_SIZE - 5;   
+            break;
+        case BOTTOM:
+            placement.x = pX;
+            placement.y = pY + PLAYER_SIZE + 5;
+            break;
+        case LEFT:
+            placement.y = pY;
+            placement.x = pX - 5 - CRATE_SIZE;
+            break;
+        case RIGHT:
+            placement.y = pY;
+            placement.x = pX + PLAYER_SIZE + 5;
+            break;
+        default:
+            break;
+    }
+
+    if (placement.x + CRATE_SIZE < plank_rect.x) placement.x = plank_rect.x - CRATE_SIZE;
+    else if (placement.x > plank_rect.x + plank_rect.width) placement.x = plank_rect.x + plank_rect.width;
+
+    Rectangle placement_rec = CRATE_BOUNDS(placement.x, placement.y - w->scroll);
+    GridMask near = grid_dense(&crates->pool, grid_query(&grid, GRID_CRATES, placement_rec));
+    for (int i = grid_mask_pop(&near); i >= 0; i = grid_mask_pop(&near)) {
+        if (check_collision_recs(placement_rec, CRATE_BOUNDS(crates->x[i], crates->y[i]))) return;
+    }
+    spawn_box(w, placement);
+    w->player.inventory -= w->params.box_cost;
+}
+
+// contacts carry handles, so an entity removed by an earlier contact is simply skipped
+static void resolve_bullet_contacts(World *w, const Contacts *contacts)
+{
+    Bullets *bullets = &w->bullets;
+    Cannons *cannons = &w->cannons;
+    for (int n = 0; n < contacts->count; n++) {
+        const Contact *c = &contacts->items[n];
+        if (c->kind < CONTACT_BULLET_PLAYER) continue;
+        int b = pool_index(&bullets->pool, c->bullet);
+        if (b < 0) continue;
+        BulletHandler *owner = &cannons->bullet[bullets->owner[b]];
+
+        switch (c->kind) {
+            case CONTACT_BULLET_PLAYER:
+                w->player.alive = (w->debug_mode) ? true : false;
+                break;
+            case CONTACT_BULLET_CRATE: {
+                int i = pool_index(&w->crates.pool, c->other);
+                if (i < 0) continue;
+                despawn_crate(w, i);
+            } break;
+            case CONTACT_BULLET_BOX: {
+                // turns back from where it met the box, not from wherever the tick left it
+                Vector2 from = {bullets->from_x[b], bullets->from_y[b]};
+                Vector2 pos = Vector2Lerp(from, (Vector2) {bullets->x[b], bullets->y[b]}, c->time);
+                Vector2 target = {bullets->target_x[b], bullets->target_y[b]};
+                Vector2 dir = Vector2Normalize(Vector2Subtract(target, from));
+                dir = (Vector2){-1 * dir.x, dir.y};
+                bullets->x[b] = pos.x;
+                bullets->y[b] = pos.y;
+                bullets->target_x[b] = pos.x + dir.x * REVERSE_REACH;
+                bullets->target_y[b] = pos.y + dir.y * REVERSE_REACH;
+                bullets->state[b] = REVERSE;
+            } continue;
+            case CONTACT_BULLET_CANNON: {
+                int i = c->other;
+                if (cannons->health[i] <= 0) continue;
+                cannons->health[i]--;
+                if (cannons->health[i] <= 0) grid_remove(&grid, GRID_CANNONS, i, CANNON_BOUNDS(cannons->x[i], cannons->y[i]));
+                owner->state = IDLE;
+                despawn_bullet(w, b);
+            } continue;
+            default:
+                break;
+        }
+        owner->state = IDLE;
+        owner->timer = 0.0f;
+        despawn_bullet(w, b);
+    }
+}
+
+void resolve_contacts(World *w, const Contacts *contacts, SimInput input)
+{
+    resolve_crate_contacts(w, contacts);
+    resolve_player_action(w, input);
+    resolve_box_contacts(w, contacts);
+    resolve_bullet_contacts(w, contacts);
+}
+
+void update_cannons(World *w, float dt)
+{
+    Cannons *cannons = &w->cannons;
+    //::update_movement::
+    int count = w->params.cannons;
+    float target_x[MAX_CANNONS] = {0}, target_y[MAX_CANNONS] = {0}, speed[MAX_CANNONS] = {0};
+    for (int i = 0; i < count; i++) {
+        // a zero speed towards its own position leaves a cannon exactly where it is
+        target_x[i] = cannons->x[i];
+        target_y[i] = cannons->y[i];
+        speed[i] = 0.0f;
+        if (cannons->health[i] <= 0) continue;
+        bool left_cannon = cannon_on_left(cannons, i);
+        MovementHandler* m = &cannons->movement[i];
+        Vector2 position = {cannons->x[i], cannons->y[i]};
+        m->timer += dt;
+        if (m->timer >= 3.0f && m->state == STATIONARY) {
+            m->state = rng_range(&w->rng.cannon_move[i], 0, 2);
+            m->timer = 0.0f;
+        }
+        switch (m->state) {
+            case STATIONARY:
+                m->target_pos = (Vector2) {0,0};
+                break;
+            case HORIZONTAL:
+            case VERTICAL:
+                if (Vector2Equals(m->target_pos, (Vector2) {0,0})) {
+                    Vector2 t = (left_cannon) ? (Vector2) {100,0} : (Vector2) {-100, 0};
+                    t = (m->state == HORIZONTAL) ? t : (Vector2) {0, 100};
+                    m->target_pos = Vector2Add(m->centre_pos, t);
+                } else if (Vector2Equals(position, m->target_pos) && !Vector2Equals(m->target_pos, m->centre_pos)) {
+                    m->target_pos = m->centre_pos;
+                } else if (Vector2Equals(position, m->centre_pos)) {
+                    m->target_pos = (Vector2) {0,0};
+                    m->state = STATIONARY;
+                    m->timer = 0.0f;
+                }
+                break;
+            default:
+                break;
+        }
+        
+        if (m->state != STATIONARY) {
+            target_x[i] = m->target_pos.x;
+            target_y[i] = m->target_pos.y;
+            speed[i] = 50.0f;
+        }
+    }
+    float from_x[MAX_CANNONS], from_y[MAX_CANNONS];
+    memcpy(from_x, cannons->x, count * sizeof(float));
+    memcpy(from_y, cannons->y, count * sizeof(float));
+    simd.move_towards(cannons->x, cannons->y, target_x, target_y, speed, dt, count);
+    for (int i = 0; i < count; i++) {
+        if (cannons->health[i] <= 0 || speed[i] == 0.0f) continue;
+        grid_move(&grid, GRID_CANNONS, i, CANNON_BOUNDS(from_x[i], from_y[i]), CANNON_BOUNDS(cannons->x[i], cannons->y[i]));
+    }
+
+    //::update_firing::
+    Bullets *bullets = &w->bullets;
+    for (int i = 0; i < count; i++) {
+        BulletHandler* b = &cannons->bullet[i];
+        b->timer += dt;
+
+        bool cannon_alive = cannons->health[i] > 0;
+        if (cannons->health[i] == 1) b->speed = w->params.damaged_bullet_speed;
+        
+        if (b->timer >= 1.0f && b->state == IDLE && cannon_alive) {
+            int chance = rng_range(&w->rng.cannon_fire[i], 1, w->params.fire_odds);
+            if (chance <= 1) {
+                b->state = LOCKING_ON;
+                b->timer = 0.0f;
+                b->bullet_position = (Vector2) {cannons->x[i], cannons->y[i]};
+            }
+        }
+        
+        if (b->state == LOCKING_ON && cannon_alive) {
+            if (b->timer < 1.0f) {
+                b->lock_on = (Vector2) {w->player.dest_rect.x + 0.5f * PLAYER_SIZE, w->player.dest_rect.y + 0.5f * PLAYER_SIZE};
+            } else {
+                int n = pool_spawn(&bullets->pool);
+                if (n >= 0) {
+                    b->state = FIRING;
+                    b->timer = 0.0f;
+                    b->bullet = bullets->pool.handles[n];
+                    bullets->x[n] = b->bullet_position.x;
+                    bullets->y[n] = b->bullet_position.y;
+                    bullets->from_x[n] = b->bullet_position.x;
+                    bullets->from_y[n] = b->bullet_position.y;
+                    bullets->target_x[n] = b->lock_on.x;
+                    bullets->target_y[n] = b->lock_on.y;
+                    bullets->speed[n] = b->speed;
+                    bullets->state[n] = FIRING;
+                    bullets->owner[n] = i;
+                }
+            }
+        }
+    }
+
+    //::update_bullets:: hits are left to collect_contacts, which sweeps each shot from where it starts the tick
+    memcpy(bullets->from_x, bullets->x, bullets->pool.count * sizeof(float));
+    memcpy(bullets->from_y, bullets->y, bullets->pool.count * sizeof(float));
+    simd.move_towards(bullets->x, bullets->y, bullets->target_x, bullets->target_y, bullets->speed, dt, bullets->pool.count);
+}
+
+// one offset moves everything riding the plank; past SCROLL_REBASE the world
+// coordinates shift back as a whole so floats keep their precision
+void update_scroll(World *w, float dt) {
+    w->scroll += SCROLL_SPEED * dt;
+    if (w->scroll < SCROLL_REBASE) return;
+    w->scroll -= SCROLL_REBASE;
+    simd.translate(w->crates.y, w->crates.pool.count, SCROLL_REBASE);
+    simd.translate(w->boxes.y, w->boxes.pool.count, SCROLL_REBASE);
+    sim_rebuild_spatial(w);
+}
+
+void update_crates(World *w, float dt) {
+    Crates *crates = &w->crates;
+    if (!pool_full(&crates->pool)) {
+        w->crate_timer += dt;
+        if (w->crate_timer > 0.3f) {
+            w->crate_timer = 0.0f;
+            int chance = rng_range(&w->rng.crate_spawn, 1, 100);
+            if (chance <= w->params.crate_chance) {
+                int x = plank_rect.x;
+                spawn_crate(w, (Vector2) {(float) rng_range(&w->rng.crate_spawn, x, x + PLANK_W - CRATE_SIZE), -CRATE_SIZE});
+            }
+        }    
+    }
+    //::cull_crates:: lowest on screen sits at the back of by_y, stop at the first one still visible
+    while (crates->by_y.count > 0) {
+        int i = pool_index(&crates->pool, crates->by_y.handles[crates->by_y.count - 1]);
+        if (crates->y[i] + w->scroll <= GAME_HEIGHT) break;
+        despawn_crate(w, i);
+    }
+}
+
+void update_boxes(World *w, float dt) {
+    (void) dt;
+    PlayerCrate *boxes = &w->boxes;
+    while (boxes->by_y.count > 0) {
+        int i = pool_index(&boxes->pool, boxes->by_y.handles[boxes->by_y.count - 1]);
+        if (boxes->y[i] + w->scroll <= GAME_HEIGHT) break;
+        despawn_box(w, i);
+    }
+}
+
+void update_planks(World *w, float dt) {
+    Planks *planks = &w->planks;
+    Vector2 player_centre = {w->player.dest_rect.x + 0.5f * PLAYER_SIZE, w->player.dest_rect.y + 0.5f * PLAYER_SIZE};
+    float speed[MAX_PLANKS] = {0};
+    int jitter[MAX_PLANKS];
+    int jitter_count = 0;
+
+    //::plank_targets:: settled planks get no speed so the batch move leaves them in place
+    for (int i = 0; i < planks->pool.count; i++) {
+        speed[i] = 0.0f;
+        if (planks->state[i] == SPAWN) {
+            Vector2 pos = {planks->x[i], planks->y[i]};
+            if (planks->target_x[i] == 0 && planks->target_y[i] == 0) {
+                Vector2 t = Vector2Subtract(pos, player_centre);
+                float length = Vector2Length(t);
+                if (length > 0) {
+                    t = Vector2Normalize(t);
+                } else {
+                    t.x = 0;
+                    t.y = -1;
+                }
+                t = Vector2Scale(t, 50.0f);
+                planks->target_x[i] = pos.x + t.x;
+                planks->target_y[i] = pos.y + t.y;
+            }
+            speed[i] = 150.0f;
+        } else if (planks->state[i] == SETTLED) {
+            planks->timer[i] += dt;
+            if (planks->timer[i] > 1.0f) {
+                planks->state[i] = ZOOMING;
+                planks->timer[i] = 0.0f;
+            } else {
+                jitter[jitter_count++] = planks->pool.handles[i];
+            }
+        }
+        if (planks->state[i] == ZOOMING) {
+            planks->target_x[i] = player_centre.x;
+            planks->target_y[i] = player_centre.y;
+            speed[i] = 300.0f;
+        }
+    }
+
+    float from_x[MAX_PLANKS], from_y[MAX_PLANKS];
+    memcpy(from_x, planks->x, planks->pool.count * sizeof(float));
+    memcpy(from_y, planks->y, planks->pool.count * sizeof(float));
+    simd.move_towards(planks->x, planks->y, planks->target_x, planks->target_y, speed, dt, planks->pool.count);
+
+    //::plank_arrivals:: a zooming plank is picked up as soon as its path touches the player
+    const float half = 0.5f * PLANK_DROP_SIZE;
+    for (int i = planks->pool.count - 1; i >= 0; i--) {
+        if (planks->state[i] != SPAWN && planks->state[i] != ZOOMING) continue;
+        Vector2 pos = {planks->x[i], planks->y[i]};
+        Vector2 target = {planks->target_x[i], planks->target_y[i]};
+
+        if (planks->state[i] == SPAWN) {
+            if (!Vector2Equals(pos, target)) continue;
+            planks->state[i] = SETTLED;
+            planks->target_x[i] = 0;
+            planks->target_y[i] = 0;
+        } else {
+            Vector2 from = {from_x[i] + half, from_y[i] + half};
+            bool touched = sweep_circle_rec(from, (Vector2) {pos.x + half, pos.y + half}, half, w->player.dest_rect) >= 0.0f;
+            if (!touched && !Vector2Equals(pos, target)) continue;
+            w->player.inventory++;
+            despawn_plank(planks, i);
+        }
+    }
+
+    //::plank_jitter:: one batched draw for every settled plank this tick
+    if (jitter_count > 0) {
+        int offsets[2 * MAX_PLANKS];
+        rng_fill_range(&w->rng.plank_jitter, offsets, 2 * jitter_count, -200, 200);
+        for (int j = 0; j < jitter_count; j++) {
+            int i = pool_index(&planks->pool, jitter[j]);
+            planks->x[i] += offsets[2 * j] * dt;
+            planks->y[i] += offsets[2 * j + 1] * dt;
+        }
+    }
+}
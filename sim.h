@@ -0,0 +1,295 @@
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "raylib.h"
+#include "rng.h"
+#include "pool.h"
+#include "grid.h"
+
+#define GAME_WIDTH 1280
+#define GAME_HEIGHT 720
+
+#define PLANK_W GAME_WIDTH * 0.2f
+#define PLANK_MOVE_RATE 12
+#define PLAYER_SIZE 64
+#define PLAYER_SPRITE_SIZE 32
+#define CANNON_RADIUS 35
+#define CANNON_SIZE 96
+#define BULLET_RADIUS 5
+#define CRATE_SIZE 64
+#define PLANK_DROP_SIZE 20
+
+// storage ceilings, the World is sized by these so it stays one flat block that
+// copies, rewinds and saves as is. SimParams picks the live limits under them,
+// stress builds raise them on the command line, each at most POOL_MAX_CAPACITY
+#ifndef MAX_CANNONS
+#define MAX_CANNONS 6
+#endif
+#ifndef MAX_CRATES
+#define MAX_CRATES 5
+#endif
+#ifndef MAX_PLANKS
+#define MAX_PLANKS 10
+#endif
+#ifndef MAX_PLAYER_CRATES
+#define MAX_PLAYER_CRATES 20
+#endif
+#if MAX_CANNONS > POOL_MAX_CAPACITY || MAX_CRATES > POOL_MAX_CAPACITY || MAX_PLANKS > POOL_MAX_CAPACITY || MAX_PLAYER_CRATES > POOL_MAX_CAPACITY
+#error "entity ceilings must fit in POOL_MAX_CAPACITY"
+#endif
+#define MAX_BULLETS MAX_CANNONS
+#define MAX_CONTACTS (MAX_CRATES + MAX_PLAYER_CRATES + 2 * MAX_BULLETS)
+#define BOX_COST 2
+
+#define SCROLL_SPEED ((float) GAME_HEIGHT / PLANK_MOVE_RATE)
+#define SCROLL_REBASE (10 * GAME_HEIGHT)     // whole plank lengths, so the background lines up across a rebase
+
+#define SIM_TICK_RATE 120
+#define SIM_DT (1.0f / SIM_TICK_RATE)
+#define SIM_MAX_SUBSTEPS 8
+
+typedef enum {
+    CANNON_LAYOUT_SIDES = 0,    // a column down each screen edge, the shipped game
+    CANNON_LAYOUT_RING,         // an ellipse round the middle of the screen
+    CANNON_LAYOUT_COUNT
+} CannonLayout;
+
+typedef enum {
+    TOP = 0,
+    RIGHT,
+    BOTTOM,
+    LEFT,
+    MAX_DIRECTIONS
+} PlayerDirection;
+
+typedef enum {
+    IDLE = 0,
+    LOCKING_ON,
+    FIRING,
+    REVERSE
+} BulletState;
+
+typedef enum {
+    STATIONARY,
+    HORIZONTAL,
+    VERTICAL
+} MovementState;
+
+typedef enum {
+    INACTIVE = 0,
+    SPAWN,
+    SETTLED,
+    ZOOMING
+} PlankState;
+
+typedef enum {
+    MAIN_MENU,
+    RESET_STATE,
+    IN_GAME
+} GameState;
+
+// resolve_contacts goes crates, the player's space action, boxes, then bullets in list order
+typedef enum {
+    CONTACT_PLAYER_CRATE = 0,
+    CONTACT_PLAYER_BOX,
+    CONTACT_BULLET_PLAYER,
+    CONTACT_BULLET_CRATE,
+    CONTACT_BULLET_BOX,
+    CONTACT_BULLET_CANNON,
+    CONTACT_BULLET_SPENT        // reached its lock on point or left the screen
+} ContactKind;
+
+typedef struct anim_handler {
+    int num_frames;
+    float timer;
+    float anim_speed;
+    int current_frame;
+} AnimationHandler;
+
+typedef struct Player {
+    Rectangle colliders[MAX_DIRECTIONS]; //::todo:: fix way we store colliders, only need 1
+    Rectangle source_rect;
+    Rectangle dest_rect;
+    AnimationHandler animation;
+    Vector2 position;
+    Color color;
+    int inventory;
+    PlayerDirection direction;
+    bool alive;
+} Player;
+
+// per cannon firing state; once FIRING the shot itself lives in Bullets
+typedef struct bullet_handler {
+    Vector2 bullet_position;    // launch point, taken when the cannon locks on
+    Vector2 lock_on;
+    float timer;
+    BulletState state;
+    int speed;
+    int bullet;                 // handle of the shot in flight, POOL_NO_HANDLE otherwise
+} BulletHandler;
+
+typedef struct movement_handler {
+    Vector2 centre_pos;
+    Vector2 target_pos;
+    float timer;
+    MovementState state;
+} MovementHandler;
+
+typedef struct Cannons {
+    float x[MAX_CANNONS];
+    float y[MAX_CANNONS];
+    BulletHandler bullet[MAX_CANNONS];
+    MovementHandler movement[MAX_CANNONS];
+    int health[MAX_CANNONS];
+} Cannons;
+
+// shots in flight, FIRING at the lock on point or REVERSE towards a point past the screen edge
+typedef struct bullets {
+    EntityPool pool;
+    float x[MAX_BULLETS];
+    float y[MAX_BULLETS];
+    float from_x[MAX_BULLETS];      // where this tick's move started, hits are swept from here
+    float from_y[MAX_BULLETS];
+    float target_x[MAX_BULLETS];
+    float target_y[MAX_BULLETS];
+    float speed[MAX_BULLETS];
+    BulletState state[MAX_BULLETS];
+    int owner[MAX_BULLETS];
+} Bullets;
+
+typedef struct planks {
+    EntityPool pool;
+    float x[MAX_PLANKS];
+    float y[MAX_PLANKS];
+    float target_x[MAX_PLANKS];
+    float target_y[MAX_PLANKS];
+    float timer[MAX_PLANKS];
+    PlankState state[MAX_PLANKS];
+} Planks;
+
+// crates and boxes ride the plank, so their y is in world coordinates: screen y = y + World.scroll
+typedef struct crates {
+    EntityPool pool;
+    PoolOrder by_y;
+    int selected;               // handle of the crate the player is touching
+    float x[MAX_CRATES];
+    float y[MAX_CRATES];
+} Crates;
+
+typedef struct player_crate {
+    EntityPool pool;
+    PoolOrder by_y;
+    float x[MAX_PLAYER_CRATES];
+    float y[MAX_PLAYER_CRATES];
+} PlayerCrate;
+
+typedef struct sim_rng {
+    uint64_t seed;
+    RngStream cannon_move[MAX_CANNONS];
+    RngStream cannon_fire[MAX_CANNONS];
+    RngStream crate_spawn;
+    RngStream plank_jitter;
+} SimRng;
+
+// one tick worth of player input, sampled by whoever drives the sim
+typedef struct sim_input {
+    bool up;
+    bool down;
+    bool left;
+    bool right;
+    bool space_pressed;
+    bool debug;
+} SimInput;
+
+typedef struct contact {
+    ContactKind kind;
+    int bullet;                 // bullet handle, POOL_NO_HANDLE for player pairs
+    int other;                  // crate or box handle, cannon id for CONTACT_BULLET_CANNON
+    float time;                 // of impact, as a fraction of the bullet's move this tick
+} Contact;
+
+typedef struct contacts {
+    Contact items[MAX_CONTACTS];
+    int count;
+} Contacts;
+
+// balance knobs, sim_default_params is the shipped game
+typedef struct sim_params {
+    int crate_chance;           // percent per crate spawn roll
+    int fire_odds;              // an idle cannon locks on for 1 in fire_odds rolls
+    int bullet_speed;
+    int damaged_bullet_speed;   // cannons down to one health fire faster
+    int box_cost;               // planks per placed box
+    // live entity limits, clamped to the MAX_* ceilings
+    int cannons;
+    int crates;
+    int planks;
+    int boxes;
+    CannonLayout cannon_layout;
+} SimParams;
+
+typedef struct world {
+    GameState game_state;
+    bool debug_mode;
+    SimParams params;
+    Player player;
+    Cannons cannons;
+    Bullets bullets;
+    Crates crates;
+    Planks planks;
+    PlayerCrate boxes;
+    float crate_timer;
+    float scroll;               // how far the plank has moved down, wraps back by SCROLL_REBASE
+    SimRng rng;
+} World;
+
+extern const Rectangle plank_rect;
+extern const SimParams sim_default_params;
+
+void sim_init(World *w, uint64_t seed);
+void sim_init_params(World *w, uint64_t seed, const SimParams *params);
+void sim_step(World *w, SimInput input, float dt);
+void sim_seed_rng(SimRng *rng, uint64_t seed);
+uint64_t sim_checksum(const World *w);
+void sim_rebuild_spatial(World *w);
+// the broadphase grid is derived from the pools, so it lives outside World where
+// clones, snapshots, rewind and save states never copy it. each thread keeps one
+// for the world it last synced, and sim_step rebuilds it when handed a different
+// World. copying a world over one in place, a clone into a reused slot or a restore,
+// needs sim_sync_grid before that memory is stepped again. it holds crates and
+// boxes in world space, live cannons in screen space
+const SpatialGrid *sim_grid(void);
+void sim_build_grid(const World *w, SpatialGrid *g);
+void sim_sync_grid(const World *w);
+
+void reset_game(World *w);
+void update_player(World *w, SimInput input, float dt);
+void bump_collision(Player *p, Rectangle obstacle);
+void spawn_plank(World *w, Vector2 crate_pos);
+void spawn_crate(World *w, Vector2 pos);
+void spawn_box(World *w, Vector2 pos);
+void despawn_bullet(World *w, int index);
+void despawn_crate(World *w, int index);
+void despawn_plank(Planks *planks, int index);
+void despawn_box(World *w, int index);
+void update_cannons(World *w, float dt);
+void collect_contacts(const World *w, Contacts *contacts);
+void resolve_contacts(World *w, const Contacts *contacts, SimInput input);
+void update_scroll(World *w, float dt);
+void update_crates(World *w, float dt);
+void update_planks(World *w, float dt);
+void update_boxes(World *w, float dt);
+
+// left hand cannons face and slide right, the rest face left
+static inline bool cannon_on_left(const Cannons *c, int i)
+{
+    return c->movement[i].centre_pos.x < GAME_WIDTH * 0.5f;
+}
+
+bool check_collision_recs(Rectangle a, Rectangle b);
+bool check_collision_circle_rec(Vector2 center, float radius, Rectangle rec);
+float sweep_circle_rec(Vector2 from, Vector2 to, float radius, Rectangle rec);
+
+#endif
@@ -0,0 +1,305 @@
+#include <math.h>
+#include <string.h>
+#include "simd.h"
+
+static bool chosen = false;
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+//::scalar::
+static void translate_scalar(float *v, int n, float d)
+{
+    for (int i = 0; i < n; i++) v[i] += d;
+}
+
+static inline void move_towards_one(float *x, float *y, float tx, float ty, float max_distance)
+{
+    float dx = tx - *x;
+    float dy = ty - *y;
+    float value = (dx * dx) + (dy * dy);
+    if ((value == 0) || ((max_distance >= 0) && (value <= max_distance * max_distance))) {
+        *x = tx;
+        *y = ty;
+        return;
+    }
+    float dist = sqrtf(value);
+    *x = *x + dx / dist * max_distance;
+    *y = *y + dy / dist * max_distance;
+}
+
+static void move_towards_scalar(float *x, float *y, const float *tx, const float *ty, const float *speed, float dt, int n)
+{
+    for (int i = 0; i < n; i++) move_towards_one(&x[i], &y[i], tx[i], ty[i], speed[i] * dt);
+}
+
+static inline bool circle_rect_one(float cx, float cy, float radius, float rx, float ry, float half_w, float half_h)
+{
+    float dx = fabsf(cx - (rx + half_w));
+    float dy = fabsf(cy - (ry + half_h));
+    if (dx > half_w + radius || dy > half_h + radius) return false;
+    if (dx <= half_w || dy <= half_h) return true;
+    float ex = dx - half_w;
+    float ey = dy - half_h;
+    return (ex * ex + ey * ey) <= radius * radius;
+}
+
+static int circle_rect_first_scalar(float cx, float cy, float radius, const float *rx, const float *ry, float rw, float rh, int n)
+{
+    float half_w = 0.5f * rw;
+    float half_h = 0.5f * rh;
+    for (int i = 0; i < n; i++) {
+        if (circle_rect_one(cx, cy, radius, rx[i], ry[i], half_w, half_h)) return i;
+    }
+    return -1;
+}
+
+// exact x / 255 rounded, for x up to 255 * 255
+static inline uint32_t div255(uint32_t x)
+{
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+static inline uint32_t blit_one(uint32_t dst, uint32_t src, uint32_t tint)
+{
+    uint32_t s[4];
+    for (int c = 0; c < 4; c++) s[c] = div255(((src >> (8 * c)) & 0xFF) * ((tint >> (8 * c)) & 0xFF));
+    uint32_t a = s[3];
+    uint32_t out = 0;
+    for (int c = 0; c < 4; c++) {
+        uint32_t d = (dst >> (8 * c)) & 0xFF;
+        out |= div255(s[c] * a + d * (255 - a)) << (8 * c);
+    }
+    return out;
+}
+
+static void blit_span_scalar(uint32_t *dst, const uint32_t *row, const int *cols, int n, uint32_t tint)
+{
+    for (int i = 0; i < n; i++) dst[i] = blit_one(dst[i], row[cols[i]], tint);
+}
+
+#if defined(SIMD_X86)
+//::sse2::
+static void translate_sse2(float *v, int n, float d)
+{
+    __m128 vd = _mm_set1_ps(d);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) _mm_storeu_ps(v + i, _mm_add_ps(_mm_loadu_ps(v + i), vd));
+    translate_scalar(v + i, n - i, d);
+}
+
+static void move_towards_sse2(float *x, float *y, const float *tx, const float *ty, const float *speed, float dt, int n)
+{
+    __m128 vdt = _mm_set1_ps(dt);
+    __m128 zero = _mm_setzero_ps();
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 px = _mm_loadu_ps(x + i), py = _mm_loadu_ps(y + i);
+        __m128 qx = _mm_loadu_ps(tx + i), qy = _mm_loadu_ps(ty + i);
+        __m128 max_distance = _mm_mul_ps(_mm_loadu_ps(speed + i), vdt);
+        __m128 dx = _mm_sub_ps(qx, px), dy = _mm_sub_ps(qy, py);
+        __m128 value = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+        __m128 snap = _mm_or_ps(_mm_cmpeq_ps(value, zero),
+            _mm_and_ps(_mm_cmpge_ps(max_distance, zero), _mm_cmple_ps(value, _mm_mul_ps(max_distance, max_distance))));
+        __m128 dist = _mm_sqrt_ps(value);
+        __m128 nx = _mm_add_ps(px, _mm_mul_ps(_mm_div_ps(dx, dist), max_distance));
+        __m128 ny = _mm_add_ps(py, _mm_mul_ps(_mm_div_ps(dy, dist), max_distance));
+        _mm_storeu_ps(x + i, _mm_or_ps(_mm_and_ps(snap, qx), _mm_andnot_ps(snap, nx)));
+        _mm_storeu_ps(y + i, _mm_or_ps(_mm_and_ps(snap, qy), _mm_andnot_ps(snap, ny)));
+    }
+    move_towards_scalar(x + i, y + i, tx + i, ty + i, speed + i, dt, n - i);
+}
+
+static int circle_rect_first_sse2(float cx, float cy, float radius, const float *rx, const float *ry, float rw, float rh, int n)
+{
+    float half_w = 0.5f * rw;
+    float half_h = 0.5f * rh;
+    __m128 vcx = _mm_set1_ps(cx), vcy = _mm_set1_ps(cy);
+    __m128 hw = _mm_set1_ps(half_w), hh = _mm_set1_ps(half_h);
+    __m128 reach_x = _mm_set1_ps(half_w + radius), reach_y = _mm_set1_ps(half_h + radius);
+    __m128 r2 = _mm_set1_ps(radius * radius);
+    __m128 sign = _mm_set1_ps(-0.0f);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 dx = _mm_andnot_ps(sign, _mm_sub_ps(vcx, _mm_add_ps(_mm_loadu_ps(rx + i), hw)));
+        __m128 dy = _mm_andnot_ps(sign, _mm_sub_ps(vcy, _mm_add_ps(_mm_loadu_ps(ry + i), hh)));
+        __m128 in_reach = _mm_and_ps(_mm_cmple_ps(dx, reach_x), _mm_cmple_ps(dy, reach_y));
+        __m128 ex = _mm_sub_ps(dx, hw), ey = _mm_sub_ps(dy, hh);
+        __m128 corner = _mm_cmple_ps(_mm_add_ps(_mm_mul_ps(ex, ex), _mm_mul_ps(ey, ey)), r2);
+        __m128 inside = _mm_or_ps(_mm_or_ps(_mm_cmple_ps(dx, hw), _mm_cmple_ps(dy, hh)), corner);
+        int mask = _mm_movemask_ps(_mm_and_ps(in_reach, inside));
+        if (mask) return i + __builtin_ctz((unsigned) mask);
+    }
+    int rest = circle_rect_first_scalar(cx, cy, radius, rx + i, ry + i, rw, rh, n - i);
+    return (rest < 0) ? -1 : i + rest;
+}
+
+static inline __m128i div255_sse2(__m128i x)
+{
+    x = _mm_add_epi16(x, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+// two pixels as eight 16 bit channels
+static inline __m128i blit_half_sse2(__m128i s, __m128i d, __m128i tint)
+{
+    s = div255_sse2(_mm_mullo_epi16(s, tint));
+    __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, 0xFF), 0xFF);
+    __m128i inv = _mm_sub_epi16(_mm_set1_epi16(255), a);
+    return div255_sse2(_mm_add_epi16(_mm_mullo_epi16(s, a), _mm_mullo_epi16(d, inv)));
+}
+
+static void blit_span_sse2(uint32_t *dst, const uint32_t *row, const int *cols, int n, uint32_t tint)
+{
+    __m128i zero = _mm_setzero_si128();
+    __m128i vt = _mm_unpacklo_epi8(_mm_set1_epi32((int) tint), zero);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i s = _mm_set_epi32((int) row[cols[i + 3]], (int) row[cols[i + 2]], (int) row[cols[i + 1]], (int) row[cols[i]]);
+        __m128i d = _mm_loadu_si128((const __m128i *) (dst + i));
+        __m128i lo = blit_half_sse2(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero), vt);
+        __m128i hi = blit_half_sse2(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero), vt);
+        _mm_storeu_si128((__m128i *) (dst + i), _mm_packus_epi16(lo, hi));
+    }
+    blit_span_scalar(dst + i, row, cols + i, n - i, tint);
+}
+
+//::avx2:: tails stay inline, calling the sse2 code with dirty upper halves stalls on the transition
+__attribute__((target("avx2")))
+static void translate_avx2(float *v, int n, float d)
+{
+    __m256 vd = _mm256_set1_ps(d);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) _mm256_storeu_ps(v + i, _mm256_add_ps(_mm256_loadu_ps(v + i), vd));
+    for (; i < n; i++) v[i] += d;
+}
+
+__attribute__((target("avx2")))
+static void move_towards_avx2(float *x, float *y, const float *tx, const float *ty, const float *speed, float dt, int n)
+{
+    __m256 vdt = _mm256_set1_ps(dt);
+    __m256 zero = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 px = _mm256_loadu_ps(x + i), py = _mm256_loadu_ps(y + i);
+        __m256 qx = _mm256_loadu_ps(tx + i), qy = _mm256_loadu_ps(ty + i);
+        __m256 max_distance = _mm256_mul_ps(_mm256_loadu_ps(speed + i), vdt);
+        __m256 dx = _mm256_sub_ps(qx, px), dy = _mm256_sub_ps(qy, py);
+        __m256 value = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+        __m256 snap = _mm256_or_ps(_mm256_cmp_ps(value, zero, _CMP_EQ_OQ),
+            _mm256_and_ps(_mm256_cmp_ps(max_distance, zero, _CMP_GE_OQ),
+                          _mm256_cmp_ps(value, _mm256_mul_ps(max_distance, max_distance), _CMP_LE_OQ)));
+        __m256 dist = _mm256_sqrt_ps(value);
+        __m256 nx = _mm256_add_ps(px, _mm256_mul_ps(_mm256_div_ps(dx, dist), max_distance));
+        __m256 ny = _mm256_add_ps(py, _mm256_mul_ps(_mm256_div_ps(dy, dist), max_distance));
+        _mm256_storeu_ps(x + i, _mm256_blendv_ps(nx, qx, snap));
+        _mm256_storeu_ps(y + i, _mm256_blendv_ps(ny, qy, snap));
+    }
+    for (; i < n; i++) move_towards_one(&x[i], &y[i], tx[i], ty[i], speed[i] * dt);
+}
+
+__attribute__((target("avx2")))
+static int circle_rect_first_avx2(float cx, float cy, float radius, const float *rx, const float *ry, float rw, float rh, int n)
+{
+    float half_w = 0.5f * rw;
+    float half_h = 0.5f * rh;
+    __m256 vcx = _mm256_set1_ps(cx), vcy = _mm256_set1_ps(cy);
+    __m256 hw = _mm256_set1_ps(half_w), hh = _mm256_set1_ps(half_h);
+    __m256 reach_x = _mm256_set1_ps(half_w + radius), reach_y = _mm256_set1_ps(half_h + radius);
+    __m256 r2 = _mm256_set1_ps(radius * radius);
+    __m256 sign = _mm256_set1_ps(-0.0f);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 dx = _mm256_andnot_ps(sign, _mm256_sub_ps(vcx, _mm256_add_ps(_mm256_loadu_ps(rx + i), hw)));
+        __m256 dy = _mm256_andnot_ps(sign, _mm256_sub_ps(vcy, _mm256_add_ps(_mm256_loadu_ps(ry + i), hh)));
+        __m256 in_reach = _mm256_and_ps(_mm256_cmp_ps(dx, reach_x, _CMP_LE_OQ), _mm256_cmp_ps(dy, reach_y, _CMP_LE_OQ));
+        __m256 ex = _mm256_sub_ps(dx, hw), ey = _mm256_sub_ps(dy, hh);
+        __m256 corner = _mm256_cmp_ps(_mm256_add_ps(_mm256_mul_ps(ex, ex), _mm256_mul_ps(ey, ey)), r2, _CMP_LE_OQ);
+        __m256 inside = _mm256_or_ps(_mm256_or_ps(_mm256_cmp_ps(dx, hw, _CMP_LE_OQ), _mm256_cmp_ps(dy, hh, _CMP_LE_OQ)), corner);
+        int mask = _mm256_movemask_ps(_mm256_and_ps(in_reach, inside));
+        if (mask) return i + __builtin_ctz((unsigned) mask);
+    }
+    for (; i < n; i++) {
+        if (circle_rect_one(cx, cy, radius, rx[i], ry[i], half_w, half_h)) return i;
+    }
+    return -1;
+}
+
+__attribute__((target("avx2")))
+static inline __m256i div255_avx2(__m256i x)
+{
+    x = _mm256_add_epi16(x, _mm256_set1_epi16(128));
+    return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i blit_half_avx2(__m256i s, __m256i d, __m256i tint)
+{
+    s = div255_avx2(_mm256_mullo_epi16(s, tint));
+    __m256i a = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s, 0xFF), 0xFF);
+    __m256i inv = _mm256_sub_epi16(_mm256_set1_epi16(255), a);
+    return div255_avx2(_mm256_add_epi16(_mm256_mullo_epi16(s, a), _mm256_mullo_epi16(d, inv)));
+}
+
+// unpack and pack both work per 128 bit lane, so pixel order survives the round trip
+__attribute__((target("avx2")))
+static void blit_span_avx2(uint32_t *dst, const uint32_t *row, const int *cols, int n, uint32_t tint)
+{
+    __m256i zero = _mm256_setzero_si256();
+    __m256i vt = _mm256_unpacklo_epi8(_mm256_set1_epi32((int) tint), zero);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i s = _mm256_i32gather_epi32((const int *) row, _mm256_loadu_si256((const __m256i *) (cols + i)), 4);
+        __m256i d = _mm256_loadu_si256((const __m256i *) (dst + i));
+        __m256i lo = blit_half_avx2(_mm256_unpacklo_epi8(s, zero), _mm256_unpacklo_epi8(d, zero), vt);
+        __m256i hi = blit_half_avx2(_mm256_unpackhi_epi8(s, zero), _mm256_unpackhi_epi8(d, zero), vt);
+        _mm256_storeu_si256((__m256i *) (dst + i), _mm256_packus_epi16(lo, hi));
+    }
+    for (; i < n; i++) dst[i] = blit_one(dst[i], row[cols[i]], tint);
+}
+#endif
+
+static const SimdKernels kernels[] = {
+    {"scalar", translate_scalar, move_towards_scalar, circle_rect_first_scalar, blit_span_scalar},
+#if defined(SIMD_X86)
+    {"sse2", translate_sse2, move_towards_sse2, circle_rect_first_sse2, blit_span_sse2},
+    {"avx2", translate_avx2, move_towards_avx2, circle_rect_first_avx2, blit_span_avx2},
+#endif
+};
+
+SimdKernels simd = {"scalar", translate_scalar, move_towards_scalar, circle_rect_first_scalar, blit_span_scalar};
+
+static bool simd_supported(const char *name)
+{
+    if (strcmp(name, "scalar") == 0) return true;
+#if defined(SIMD_X86)
+    __builtin_cpu_init();
+    if (strcmp(name, "sse2") == 0) return __builtin_cpu_supports("sse2");
+    if (strcmp(name, "avx2") == 0) return __builtin_cpu_supports("avx2");
+#endif
+    return false;
+}
+
+bool simd_select(const char *name)
+{
+    for (size_t i = 0; i < sizeof(kernels) / sizeof(kernels[0]); i++) {
+        if (strcmp(kernels[i].name, name) == 0 && simd_supported(name)) {
+            simd = kernels[i];
+            chosen = true;
+            return true;
+        }
+    }
+    return false;
+}
+
+// best supported variant, unless one was already picked
+void simd_init(void)
+{
+    if (chosen) return;
+    if (simd_select("avx2")) return;
+    if (simd_select("sse2")) return;
+    simd_select("scalar");
+}
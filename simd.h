@@ -0,0 +1,28 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// batch kernels over packed x/y arrays, picked at runtime from what the cpu supports
+// every variant does the same float operations in the same order as the scalar
+// code in raymath, so results are bit identical and replays stay portable
+
+typedef struct simd_kernels {
+    const char *name;
+    // v[i] += d
+    void (*translate)(float *v, int n, float d);
+    // Vector2MoveTowards with a per entity step of speed[i] * dt
+    void (*move_towards)(float *x, float *y, const float *tx, const float *ty, const float *speed, float dt, int n);
+    // index of the first equally sized rect the circle touches, -1 for none
+    int (*circle_rect_first)(float cx, float cy, float radius, const float *rx, const float *ry, float rw, float rh, int n);
+    // dst[i] = row[cols[i]] * tint alpha blended over dst[i], rgba8 packed little endian
+    void (*blit_span)(uint32_t *dst, const uint32_t *row, const int *cols, int n, uint32_t tint);
+} SimdKernels;
+
+extern SimdKernels simd;
+
+void simd_init(void);
+bool simd_select(const char *name);
+
+#endif
@@ -0,0 +1,229 @@
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+#include "replay.h"
+#include "invariants.h"
+#include "taskpool.h"
+#include "timing.h"
+#include "simd.h"
+
+// soak fuzzer: random play episodes across every core with the invariants checked
+// after every tick. the first failure is shrunk to a short input trace and written
+// as a replay, run it again with --replay to see the break without the search
+// usage: 20g_plank_soak [--episodes N] [--threads N] [--seed S] [--max-ticks N] [--out FILE] [--replay FILE]
+
+#define SOAK_BATCH 4096             // episodes between progress lines and failure checks
+#define SOAK_SHRINK_RUNS 4000       // re-runs the shrinker may spend
+
+typedef struct soak {
+    uint64_t seed;
+    int max_ticks;
+    // shared, __atomic builtins
+    long long failed;               // lowest failing episode, LLONG_MAX while none has
+    long long ticks;
+    long long base;                 // first episode of the running batch
+} Soak;
+
+typedef struct episode {
+    uint64_t seed;
+    int fail_tick;                  // -1 when every tick held
+    char why[160];
+} Episode;
+
+static uint64_t episode_seed(uint64_t seed, long long episode)
+{
+    uint64_t z = seed + (uint64_t) (episode + 1) * 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// an episode runs until the game is back on the menu after a death, so the reset is checked too.
+// with a trace it plays that instead of wandering and stops where the trace does,
+// with record it keeps what it played
+static int run_episode(Episode *e, int max_ticks, const uint8_t *trace, int trace_len, uint8_t *record)
+{
+    World w;
+    sim_init(&w, e->seed);
+    WanderInput wi = wander_init(e->seed);
+    e->fail_tick = -1;
+    int t = 0;
+    for (; t < max_ticks && w.game_state != MAIN_MENU; t++) {
+        if (trace && t >= trace_len) break;
+        SimInput input = trace ? unpack_input(trace[t]) : wander_input(&wi);
+        if (record) record[t] = pack_input(input);
+        sim_step(&w, input, SIM_DT);
+        if (!world_invariants(&w, e->why, sizeof(e->why))) {
+            e->fail_tick = t;
+            return t + 1;
+        }
+    }
+    return t;
+}
+
+static void soak_range(void *ctx, int begin, int end)
+{
+    Soak *s = ctx;
+    long long base = s->base;
+    long long ticks = 0;
+    for (int i = begin; i < end; i++) {
+        long long n = base + i;
+        if (n > __atomic_load_n(&s->failed, __ATOMIC_RELAXED)) break;
+        Episode e = {.seed = episode_seed(s->seed, n)};
+        ticks += run_episode(&e, s->max_ticks, NULL, 0, NULL);
+        if (e.fail_tick < 0) continue;
+        long long seen = __atomic_load_n(&s->failed, __ATOMIC_RELAXED);
+        while (n < seen && !__atomic_compare_exchange_n(&s->failed, &seen, n, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {}
+    }
+    __atomic_fetch_add(&s->ticks, ticks, __ATOMIC_RELAXED);
+}
+
+// ddmin style: blank out ever smaller windows of input, keep a blanking whenever
+// the run still breaks an invariant, and cut the trace at the new failing tick
+static int shrink(Episode *e, uint8_t *trace, int len, int max_ticks)
+{
+    uint8_t *candidate = malloc(len);
+    if (!candidate) return len;
+    int runs = 0;
+    for (int window = len / 2; window >= 1 && runs < SOAK_SHRINK_RUNS; window /= 2) {
+        for (int start = 0; start < len && runs < SOAK_SHRINK_RUNS; start += window) {
+            int stop = (start + window < len) ? start + window : len;
+            bool blank = true;
+            for (int t = start; t < stop; t++) blank &= trace[t] == 0;
+            if (blank) continue;
+
+            memcpy(candidate, trace, len);
+            memset(candidate + start, 0, stop - start);
+            Episode attempt = {.seed = e->seed};
+            run_episode(&attempt, max_ticks, candidate, len, NULL);
+            runs++;
+            if (attempt.fail_tick < 0) continue;
+            len = attempt.fail_tick + 1;
+            memcpy(trace, candidate, len);
+            *e = attempt;
+        }
+    }
+    free(candidate);
+    return len;
+}
+
+static bool write_repro(const char *path, uint64_t seed, const uint8_t *trace, int len)
+{
+    ReplayWriter rw = {0};
+    if (!replay_writer_open(&rw, path, seed)) return false;
+    for (int t = 0; t < len; t++) replay_writer_push(&rw, unpack_input(trace[t]));
+    replay_writer_close(&rw);
+    return true;
+}
+
+static int check_replay(const char *path, int max_ticks)
+{
+    ReplayReader rr = {0};
+    if (!replay_reader_open(&rr, path)) {
+        printf("Couldn't open replay %s\n", path);
+        return -1;
+    }
+    uint8_t *trace = malloc(max_ticks);
+    if (!trace) {
+        replay_reader_close(&rr);
+        return -1;
+    }
+    int len = 0;
+    SimInput input;
+    while (len < max_ticks && replay_reader_next(&rr, &input)) trace[len++] = pack_input(input);
+    Episode e = {.seed = rr.seed};
+    replay_reader_close(&rr);
+    run_episode(&e, max_ticks, trace, len, NULL);
+    free(trace);
+    if (e.fail_tick < 0) {
+        printf("seed %llu, %d ticks, every invariant held\n", (unsigned long long) e.seed, len);
+        return 0;
+    }
+    printf("seed %llu, invariant broken at tick %d: %s\n", (unsigned long long) e.seed, e.fail_tick, e.why);
+    return 1;
+}
+
+int main(int argc, char* argv[])
+{
+    long long episodes = 1000000;
+    int threads = 0;
+    uint64_t seed = 1;
+    int max_ticks = 2 * 60 * SIM_TICK_RATE;
+    const char *out_path = "soak_repro.replay";
+    const char *replay_path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--episodes") == 0 && i + 1 < argc) {
+            episodes = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--max-ticks") == 0 && i + 1 < argc) {
+            max_ticks = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            out_path = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replay_path = argv[++i];
+        } else {
+            printf("usage: %s [--episodes N] [--threads N] [--seed S] [--max-ticks N] [--out FILE] [--replay FILE]\n", argv[0]);
+            return -1;
+        }
+    }
+    if (max_ticks < 1) max_ticks = 1;
+    if (replay_path) return check_replay(replay_path, max_ticks);
+
+    // sim_init fills the dispatch table lazily, do it before the workers race for it
+    simd_init();
+    TaskPool pool;
+    if (!task_pool_init(&pool, threads)) {
+        printf("Couldn't start the worker threads\n");
+        return -1;
+    }
+
+    Soak s = {.seed = seed, .max_ticks = max_ticks, .failed = LLONG_MAX};
+    long long done = 0;
+    uint64_t start = timing_now_ns();
+    uint64_t last_report = start;
+    while (done < episodes && s.failed == LLONG_MAX) {
+        long long batch = (episodes - done < SOAK_BATCH) ? episodes - done : SOAK_BATCH;
+        s.base = done;
+        task_pool_run(&pool, (int) batch, 1, soak_range, &s);
+        done += batch;
+        uint64_t now = timing_now_ns();
+        if (now - last_report > 5000000000ull) {
+            double t = (double) (now - start) * 1e-9;
+            printf("%lld episodes, %.0f episodes/s\n", done, done / t);
+            fflush(stdout);
+            last_report = now;
+        }
+    }
+    double elapsed = (double) (timing_now_ns() - start) * 1e-9;
+    if (s.failed != LLONG_MAX) done = s.failed + 1;
+    printf("seed %llu, simd %s, %d threads\n", (unsigned long long) seed, simd.name, pool.count);
+    task_pool_free(&pool);
+
+    printf("episodes %lld in %.3fs (%.0f episodes/s, %.0f ticks/s)\n", done, elapsed,
+        elapsed > 0 ? done / elapsed : 0.0, elapsed > 0 ? s.ticks / elapsed : 0.0);
+    if (s.failed == LLONG_MAX) {
+        printf("every invariant held\n");
+        return 0;
+    }
+
+    // replay the first failure serially to capture its input, then shrink it
+    Episode e = {.seed = episode_seed(seed, s.failed)};
+    uint8_t *trace = malloc(max_ticks);
+    if (!trace) return 1;
+    int len = run_episode(&e, max_ticks, NULL, 0, trace);
+    printf("episode %lld, seed %llu, invariant broken at tick %d: %s\n", s.failed, (unsigned long long) e.seed, e.fail_tick, e.why);
+    len = shrink(&e, trace, len, max_ticks);
+    int inputs = 0;
+    for (int t = 0; t < len; t++) inputs += trace[t] != 0;
+    printf("shrunk to %d ticks with %d non-idle inputs: %s\n", len, inputs, e.why);
+    if (write_repro(out_path, e.seed, trace, len)) printf("Wrote %s\n", out_path);
+    else printf("Couldn't write %s\n", out_path);
+    free(trace);
+    return 1;
+}
@@ -0,0 +1,290 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+#include "replay.h"
+#include "timing.h"
+#include "simd.h"
+#include "render.h"
+#include "render_soft.h"
+#include "scene.h"
+
+// stress driver: fills worlds to given entity limits and times ticks and frames as they scale
+// usage: 20g_plank_stress [--cannons LIST] [--crates LIST] [--planks N] [--boxes N] [--layout sides|ring]
+//                         [--ticks N] [--seed S] [--no-render] [--out FILE] [--simd scalar|sse2|avx2]
+// LIST is comma separated and every cannon and crate count pair runs in turn, one json
+// object per line. counts past this build's MAX_* ceilings are clamped, `make stress`
+// raises the ceilings far past the shipped game's
+
+#define FRAME_TICKS 2
+#define MAX_STEPS 32
+
+typedef struct stress_config {
+    int cannons[MAX_STEPS];
+    int cannon_steps;
+    int crates[MAX_STEPS];
+    int crate_steps;
+    int planks;
+    int boxes;
+    CannonLayout layout;
+    int ticks;
+    uint64_t seed;
+    bool render;
+    FILE *out;
+} StressConfig;
+
+typedef struct stress_stats {
+    SimParams params;           // after clamping to the ceilings
+    double *tick_ns;
+    double *frame_ns;
+    int frames;
+    long long live_crates, live_bullets, live_planks, live_boxes;
+    int over_budget;            // ticks slower than the tick they simulate
+    int falls;                  // debug mode doesn't save a player pushed off the plank
+    RenderStats render;
+} StressStats;
+
+static const char *layout_names[CANNON_LAYOUT_COUNT] = {"sides", "ring"};
+
+static int parse_list(const char *s, int *out)
+{
+    int n = 0;
+    while (*s && n < MAX_STEPS) {
+        char *end;
+        long v = strtol(s, &end, 10);
+        if (end == s) return 0;
+        out[n++] = (int) v;
+        s = (*end == ',') ? end + 1 : end;
+    }
+    return n;
+}
+
+// every entity starts out at the limit: crates spread over the plank from two screens
+// up, boxes in rows below them, planks on their way to the player
+static void fill_world(World *w, uint64_t seed)
+{
+    RngStream rng = rng_stream(seed, 0);
+    int x = plank_rect.x;
+    for (int i = 0; i < w->params.crates; i++) {
+        float cx = (float) rng_range(&rng, x, x + PLANK_W - CRATE_SIZE);
+        float cy = (float) rng_range(&rng, -2 * GAME_HEIGHT, GAME_HEIGHT - 2 * PLAYER_SIZE);
+        spawn_crate(w, (Vector2) {cx, cy});
+    }
+    for (int i = 0; i < w->params.boxes; i++) {
+        spawn_box(w, (Vector2) {
+            plank_rect.x + (i % 4) * CRATE_SIZE,
+            (float) rng_range(&rng, -2 * GAME_HEIGHT, GAME_HEIGHT - 2 * PLAYER_SIZE)
+        });
+    }
+    for (int i = 0; i < w->params.planks; i++) {
+        spawn_plank(w, (Vector2) {(float) rng_range(&rng, 0, GAME_WIDTH), (float) rng_range(&rng, 0, GAME_HEIGHT)});
+    }
+}
+
+static int compare_double(const void *a, const void *b)
+{
+    double x = *(const double *) a;
+    double y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+
+static double percentile(const double *sorted, int n, double p)
+{
+    if (n <= 0) return 0.0;
+    double rank = p * (n - 1);
+    int lo = (int) rank;
+    int hi = (lo + 1 < n) ? lo + 1 : lo;
+    return sorted[lo] + (sorted[hi] - sorted[lo]) * (rank - lo);
+}
+
+static void print_times(FILE *out, const char *name, double *ns, int n)
+{
+    qsort(ns, n, sizeof(double), compare_double);
+    double sum = 0.0;
+    for (int i = 0; i < n; i++) sum += ns[i];
+    fprintf(out, "\"%s\":{\"mean\":%.1f,\"p50\":%.1f,\"p99\":%.1f,\"max\":%.1f}", name,
+        n ? sum / n * 1e-3 : 0.0, percentile(ns, n, 0.5) * 1e-3, percentile(ns, n, 0.99) * 1e-3, n ? ns[n - 1] * 1e-3 : 0.0);
+}
+
+// debug input keeps shots from killing the player; one pushed off the plank is put
+// back where it started, a reset would throw the filled world away
+static void run(const StressConfig *cfg, SimParams params, StressStats *st, Texture2D sheet, Background *background)
+{
+    static World world;
+    static World prev_world;
+    sim_init_params(&world, cfg->seed, &params);
+    fill_world(&world, cfg->seed);
+    st->params = world.params;
+    WanderInput wi = wander_init(cfg->seed);
+
+    st->frames = 0;
+    st->live_crates = st->live_bullets = st->live_planks = st->live_boxes = 0;
+    st->over_budget = 0;
+    st->falls = 0;
+    Player start_player = world.player;
+    for (int t = 0; t < cfg->ticks; t++) {
+        SimInput input = wander_input(&wi);
+        input.debug = true;
+        bool frame = cfg->render && (t + 1) % FRAME_TICKS == 0;
+        if (frame) prev_world = world;
+
+        uint64_t start = timing_now_ns();
+        sim_step(&world, input, SIM_DT);
+        st->tick_ns[t] = (double) (timing_now_ns() - start);
+        if (st->tick_ns[t] > SIM_DT * 1e9) st->over_budget++;
+        if (!world.player.alive) {
+            world.player = start_player;
+            st->falls++;
+        }
+
+        st->live_crates += world.crates.pool.count;
+        st->live_bullets += world.bullets.pool.count;
+        st->live_planks += world.planks.pool.count;
+        st->live_boxes += world.boxes.pool.count;
+
+        if (frame) {
+            uint64_t render_start = timing_now_ns();
+            background_update(background, FRAME_TICKS * SIM_DT);
+            render_clear(C_BLUE);
+            render_begin();
+            scene_draw(&(Scene) {&world, &prev_world, 0.5f, sheet, background, false});
+            render_flush();
+            st->frame_ns[st->frames++] = (double) (timing_now_ns() - render_start);
+            st->render = render_last_stats();
+        }
+    }
+}
+
+static void report(const StressConfig *cfg, StressStats *st)
+{
+    const SimParams *p = &st->params;
+    double ticks = cfg->ticks;
+    fprintf(cfg->out, "{\"cannons\":%d,\"crates\":%d,\"planks\":%d,\"boxes\":%d,\"layout\":\"%s\",\"simd\":\"%s\",\"ticks\":%d,",
+        p->cannons, p->crates, p->planks, p->boxes, layout_names[p->cannon_layout], simd.name, cfg->ticks);
+    fprintf(cfg->out, "\"live\":{\"crates\":%.1f,\"bullets\":%.1f,\"planks\":%.1f,\"boxes\":%.1f},",
+        st->live_crates / ticks, st->live_bullets / ticks, st->live_planks / ticks, st->live_boxes / ticks);
+    print_times(cfg->out, "tick_us", st->tick_ns, cfg->ticks);
+    fprintf(cfg->out, ",\"over_budget\":%d,\"falls\":%d", st->over_budget, st->falls);
+    if (cfg->render) {
+        fprintf(cfg->out, ",");
+        print_times(cfg->out, "frame_us", st->frame_ns, st->frames);
+        fprintf(cfg->out, ",\"draws\":%d,\"batches\":%d,\"dropped\":%d", st->render.draws, st->render.batches, st->render.dropped);
+    }
+    fprintf(cfg->out, "}\n");
+    fflush(cfg->out);
+}
+
+int main(int argc, char* argv[])
+{
+    StressConfig cfg = {
+        .cannons = {6, 64, 256},
+        .cannon_steps = 3,
+        .crates = {5, 256, 1024, 4096},
+        .crate_steps = 4,
+        .planks = sim_default_params.planks,
+        .boxes = sim_default_params.boxes,
+        .layout = CANNON_LAYOUT_SIDES,
+        .ticks = 600,
+        .seed = 1,
+        .render = true,
+        .out = stdout,
+    };
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--cannons") == 0 && i + 1 < argc) {
+            cfg.cannon_steps = parse_list(argv[++i], cfg.cannons);
+        } else if (strcmp(argv[i], "--crates") == 0 && i + 1 < argc) {
+            cfg.crate_steps = parse_list(argv[++i], cfg.crates);
+        } else if (strcmp(argv[i], "--planks") == 0 && i + 1 < argc) {
+            cfg.planks = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--boxes") == 0 && i + 1 < argc) {
+            cfg.boxes = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--layout") == 0 && i + 1 < argc) {
+            i++;
+            cfg.layout = CANNON_LAYOUT_COUNT;
+            for (int l = 0; l < CANNON_LAYOUT_COUNT; l++) {
+                if (strcmp(argv[i], layout_names[l]) == 0) cfg.layout = (CannonLayout) l;
+            }
+            if (cfg.layout == CANNON_LAYOUT_COUNT) {
+                printf("No cannon layout named %s\n", argv[i]);
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) {
+            cfg.ticks = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            cfg.seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--no-render") == 0) {
+            cfg.render = false;
+        } else if (strcmp(argv[i], "--simd") == 0 && i + 1 < argc) {
+            if (!simd_select(argv[++i])) {
+                printf("simd variant %s isn't available on this cpu\n", argv[i]);
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            cfg.out = fopen(argv[++i], "w");
+            if (!cfg.out) {
+                printf("Couldn't open %s\n", argv[i]);
+                return -1;
+            }
+        } else {
+            printf("usage: %s [--cannons LIST] [--crates LIST] [--planks N] [--boxes N] [--layout sides|ring]\n"
+                   "       [--ticks N] [--seed S] [--no-render] [--out FILE] [--simd scalar|sse2|avx2]\n", argv[0]);
+            return -1;
+        }
+    }
+    if (cfg.cannon_steps < 1 || cfg.crate_steps < 1) {
+        printf("--cannons and --crates take comma separated counts\n");
+        return -1;
+    }
+    if (cfg.ticks < 1) cfg.ticks = 1;
+    fprintf(stderr, "ceilings: %d cannons, %d crates, %d planks, %d boxes\n", MAX_CANNONS, MAX_CRATES, MAX_PLANKS, MAX_PLAYER_CRATES);
+
+    Texture2D sheet = {0};
+    Background background = {0};
+    if (cfg.render) {
+        uint32_t *pixels = soft_placeholder_sheet();
+        if (!pixels || !soft_init(GAME_WIDTH, GAME_HEIGHT)) {
+            printf("Couldn't set up the software renderer\n");
+            free(pixels);
+            return -1;
+        }
+        sheet = soft_texture_load(pixels, SOFT_SHEET_SIZE, SOFT_SHEET_SIZE);
+        free(pixels);
+        if (!background_bake(&background, sheet)) {
+            printf("Couldn't bake background\n");
+            soft_shutdown();
+            return -1;
+        }
+    }
+
+    StressStats st = {0};
+    st.tick_ns = malloc(cfg.ticks * sizeof(double));
+    st.frame_ns = malloc((cfg.ticks / FRAME_TICKS + 1) * sizeof(double));
+    if (!st.tick_ns || !st.frame_ns) return -1;
+
+    // every idle cannon locks on each second and every roll spawns, so the live
+    // counts track the limits instead of the shipped game's pacing
+    SimParams params = sim_default_params;
+    params.fire_odds = 1;
+    params.crate_chance = 100;
+    params.planks = cfg.planks;
+    params.boxes = cfg.boxes;
+    params.cannon_layout = cfg.layout;
+    for (int c = 0; c < cfg.cannon_steps; c++) {
+        for (int k = 0; k < cfg.crate_steps; k++) {
+            params.cannons = cfg.cannons[c];
+            params.crates = cfg.crates[k];
+            run(&cfg, params, &st, sheet, &background);
+            report(&cfg, &st);
+        }
+    }
+
+    free(st.tick_ns);
+    free(st.frame_ns);
+    if (cfg.render) {
+        background_unload(&background);
+        soft_shutdown();
+    }
+    if (cfg.out != stdout) fclose(cfg.out);
+    return 0;
+}
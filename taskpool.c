@@ -0,0 +1,122 @@
+#if !defined(_WIN32)
+#define _POSIX_C_SOURCE 200809L
+#include <unistd.h>
+#else
+#include <windows.h>
+#endif
+#include "taskpool.h"
+
+int task_pool_cpu_count(void)
+{
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    int n = (int) info.dwNumberOfProcessors;
+#else
+    int n = (int) sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    if (n < 1) n = 1;
+    if (n > TASK_POOL_MAX_THREADS) n = TASK_POOL_MAX_THREADS;
+    return n;
+}
+
+// own range first, then walk the others; a claim past end means that range is empty
+static void drain(TaskPool *p, int self)
+{
+    for (int k = 0; k < p->count; k++) {
+        TaskRange *r = &p->ranges[(self + k) % p->count];
+        for (;;) {
+            int begin = __atomic_fetch_add(&r->next, p->grain, __ATOMIC_RELAXED);
+            if (begin >= r->end) break;
+            int end = (begin + p->grain < r->end) ? begin + p->grain : r->end;
+            p->fn(p->ctx, begin, end);
+        }
+    }
+}
+
+static void *worker_loop(void *arg)
+{
+    TaskWorker *tw = arg;
+    TaskPool *p = tw->pool;
+    unsigned seen = 0;
+    pthread_mutex_lock(&p->lock);
+    for (;;) {
+        while (p->generation == seen && !p->stopping) pthread_cond_wait(&p->start, &p->lock);
+        if (p->stopping) break;
+        seen = p->generation;
+        pthread_mutex_unlock(&p->lock);
+
+        drain(p, tw->index);
+
+        pthread_mutex_lock(&p->lock);
+        if (--p->busy == 0) pthread_cond_signal(&p->done);
+    }
+    pthread_mutex_unlock(&p->lock);
+    return NULL;
+}
+
+// threads <= 0 takes one per cpu
+bool task_pool_init(TaskPool *p, int threads)
+{
+    if (threads <= 0) threads = task_pool_cpu_count();
+    if (threads > TASK_POOL_MAX_THREADS) threads = TASK_POOL_MAX_THREADS;
+    p->count = 1;
+    p->generation = 0;
+    p->busy = 0;
+    p->stopping = false;
+    pthread_mutex_init(&p->lock, NULL);
+    pthread_cond_init(&p->start, NULL);
+    pthread_cond_init(&p->done, NULL);
+    for (int i = 1; i < threads; i++) {
+        p->workers[i] = (TaskWorker) {p, i};
+        if (pthread_create(&p->threads[i], NULL, worker_loop, &p->workers[i]) != 0) {
+            task_pool_free(p);
+            return false;
+        }
+        p->count++;
+    }
+    return true;
+}
+
+void task_pool_run(TaskPool *p, int count, int grain, TaskFn fn, void *ctx)
+{
+    if (count <= 0) return;
+    if (grain < 1) grain = 1;
+    p->fn = fn;
+    p->ctx = ctx;
+    p->grain = grain;
+    for (int i = 0; i < p->count; i++) {
+        p->ranges[i].next = (int) ((long long) count * i / p->count);
+        p->ranges[i].end = (int) ((long long) count * (i + 1) / p->count);
+    }
+    if (p->count == 1) {
+        drain(p, 0);
+        return;
+    }
+
+    // the lock publishes the ranges above to the workers
+    pthread_mutex_lock(&p->lock);
+    p->busy = p->count - 1;
+    p->generation++;
+    pthread_cond_broadcast(&p->start);
+    pthread_mutex_unlock(&p->lock);
+
+    drain(p, 0);
+
+    pthread_mutex_lock(&p->lock);
+    while (p->busy > 0) pthread_cond_wait(&p->done, &p->lock);
+    pthread_mutex_unlock(&p->lock);
+}
+
+void task_pool_free(TaskPool *p)
+{
+    pthread_mutex_lock(&p->lock);
+    p->stopping = true;
+    pthread_cond_broadcast(&p->start);
+    pthread_mutex_unlock(&p->lock);
+    for (int i = 1; i < p->count; i++) pthread_join(p->threads[i], NULL);
+    p->count = 0;
+    pthread_mutex_destroy(&p->lock);
+    pthread_cond_destroy(&p->start);
+    pthread_cond_destroy(&p->done);
+}
@@ -0,0 +1,49 @@
+#ifndef TASKPOOL_H
+#define TASKPOOL_H
+
+#include <stdbool.h>
+#include <pthread.h>
+
+// fork-join pool for data parallel loops: task_pool_run splits [0, count) into one
+// range per thread, each thread takes grain sized chunks off its own range and
+// steals chunks off the others once it runs dry, the calling thread works too
+
+#define TASK_POOL_MAX_THREADS 64
+
+typedef void (*TaskFn)(void *ctx, int begin, int end);
+
+// padded to a cache line so owners and thieves of different ranges don't share one
+typedef struct task_range {
+    int next;                   // shared, claimed with __atomic_fetch_add
+    int end;
+    char pad[64 - 2 * sizeof(int)];
+} TaskRange;
+
+typedef struct task_worker {
+    struct task_pool *pool;
+    int index;
+} TaskWorker;
+
+typedef struct task_pool {
+    TaskRange ranges[TASK_POOL_MAX_THREADS];
+    pthread_t threads[TASK_POOL_MAX_THREADS];
+    TaskWorker workers[TASK_POOL_MAX_THREADS];
+    int count;                  // threads including the caller
+    TaskFn fn;
+    void *ctx;
+    int grain;
+    // job hand off only, the chunks themselves never take the lock
+    pthread_mutex_t lock;
+    pthread_cond_t start;
+    pthread_cond_t done;
+    unsigned generation;
+    int busy;
+    bool stopping;
+} TaskPool;
+
+int task_pool_cpu_count(void);
+bool task_pool_init(TaskPool *p, int threads);
+void task_pool_run(TaskPool *p, int count, int grain, TaskFn fn, void *ctx);
+void task_pool_free(TaskPool *p);
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef TIMING_H
+#define TIMING_H
+
+#include <stdint.h>
+
+// monotonic wall clock in nanoseconds, independent of raylib's GetTime
+// (lives in timing.c so windows.h never meets raylib.h)
+uint64_t timing_now_ns(void);
+void timing_sleep_ms(int ms);
+
+#endif
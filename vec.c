@@ -0,0 +1,105 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "vecworld.h"
+#include "replay.h"
+#include "timing.h"
+#include "simd.h"
+
+// batch driver: random play across many worlds at once, for balancing runs
+// usage: 20g_plank_vec [--worlds N] [--threads N] [--steps N] [--seed S] [--frame-skip N] [--max-ticks N]
+//                      [--crate-chance PERCENT] [--fire-odds N] [--bullet-speed N] [--damaged-bullet-speed N] [--box-cost N]
+//                      [--simd scalar|sse2|avx2]
+
+int main(int argc, char* argv[])
+{
+    VecConfig config = {
+        .count = 4096,
+        .threads = 0,
+        .seed = 1,
+        .frame_skip = 4,
+        .max_episode_ticks = 0,
+        .params = sim_default_params,
+    };
+    int steps = 1000;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--worlds") == 0 && i + 1 < argc) {
+            config.count = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            config.threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--steps") == 0 && i + 1 < argc) {
+            steps = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            config.seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--frame-skip") == 0 && i + 1 < argc) {
+            config.frame_skip = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--max-ticks") == 0 && i + 1 < argc) {
+            config.max_episode_ticks = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--crate-chance") == 0 && i + 1 < argc) {
+            config.params.crate_chance = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--fire-odds") == 0 && i + 1 < argc) {
+            config.params.fire_odds = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--bullet-speed") == 0 && i + 1 < argc) {
+            config.params.bullet_speed = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--damaged-bullet-speed") == 0 && i + 1 < argc) {
+            config.params.damaged_bullet_speed = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--box-cost") == 0 && i + 1 < argc) {
+            config.params.box_cost = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--simd") == 0 && i + 1 < argc) {
+            if (!simd_select(argv[++i])) {
+                printf("simd variant %s isn't available on this cpu\n", argv[i]);
+                return -1;
+            }
+        } else {
+            printf("usage: %s [--worlds N] [--threads N] [--steps N] [--seed S] [--frame-skip N] [--max-ticks N]\n"
+                   "       [--crate-chance PERCENT] [--fire-odds N] [--bullet-speed N] [--damaged-bullet-speed N] [--box-cost N]\n"
+                   "       [--simd scalar|sse2|avx2]\n", argv[0]);
+            return -1;
+        }
+    }
+
+    static VecWorlds vec;
+    if (!vec_init(&vec, &config)) {
+        printf("Couldn't set up %d worlds\n", config.count);
+        return -1;
+    }
+
+    RngStream actions = rng_stream(config.seed, 0);
+    long long finished = 0, finished_ticks = 0, finished_inventory = 0;
+    double reward = 0.0, survived = 0.0;
+    uint64_t step_ns = 0;
+    for (int s = 0; s < steps; s++) {
+        for (int i = 0; i < config.count; i++) {
+            vec.actions[i] = (uint8_t) (rng_next(&actions) & (INPUT_UP | INPUT_DOWN | INPUT_LEFT | INPUT_RIGHT | INPUT_SPACE));
+        }
+        uint64_t start = timing_now_ns();
+        vec_step(&vec);
+        step_ns += timing_now_ns() - start;
+        for (int i = 0; i < config.count; i++) {
+            reward += vec.rewards[i];
+            survived += vec.survived[i];
+            if (!vec.dones[i]) continue;
+            finished++;
+            finished_ticks += vec.last_episode_ticks[i];
+            finished_inventory += vec.last_inventory[i];
+        }
+    }
+
+    double elapsed = (double) step_ns * 1e-9;
+    double world_steps = (double) steps * config.count;
+    printf("worlds %d on %d threads, simd %s\n", config.count, vec.pool.count, simd.name);
+    // as sim_init_params clamped them
+    const SimParams *params = &vec.worlds[0].params;
+    printf("params crate %d%%, fire 1 in %d, bullet speed %d/%d, box cost %d\n",
+        params->crate_chance, params->fire_odds, params->bullet_speed,
+        params->damaged_bullet_speed, params->box_cost);
+    printf("%d steps of %d ticks in %.3fs (%.0f world steps/s, %.0f ticks/s)\n", steps, config.frame_skip, elapsed,
+        elapsed > 0 ? world_steps / elapsed : 0.0, elapsed > 0 ? world_steps * config.frame_skip / elapsed : 0.0);
+    printf("episodes %lld, mean length %.1f ticks, mean final inventory %.2f, mean reward per step %.3f, survived %.1f%% of ticks\n", finished,
+        finished ? (double) finished_ticks / finished : 0.0, finished ? (double) finished_inventory / finished : 0.0,
+        reward / world_steps, 100.0 * survived / (world_steps * config.frame_skip));
+
+    vec_free(&vec);
+    return 0;
+}
@@ -0,0 +1,174 @@
+#include <stdlib.h>
+#include <string.h>
+#include "vecworld.h"
+#include "replay.h"
+#include "simd.h"
+
+#define VEC_SEED_SALT 0x8BB84B93962EACC9ull
+
+typedef struct vec_job {
+    VecWorlds *v;
+    bool reset;
+} VecJob;
+
+static uint64_t next_seed(RngStream *s)
+{
+    uint64_t hi = rng_next(s);
+    return (hi << 32) | rng_next(s);
+}
+
+static void start_episode(VecWorlds *v, int i)
+{
+    v->episode_seeds[i] = next_seed(&v->seeders[i]);
+    sim_init_params(&v->worlds[i], v->episode_seeds[i], &v->config.params);
+    v->episode_ticks[i] = 0;
+}
+
+// positions are scaled to roughly [0, 1] so every world reads the same whatever the layout
+static void observe(const World *w, float *o)
+{
+    *o++ = w->player.dest_rect.x / GAME_WIDTH;
+    *o++ = w->player.dest_rect.y / GAME_HEIGHT;
+    *o++ = (float) w->player.inventory;
+    *o++ = w->player.alive ? 1.0f : 0.0f;
+
+    const Cannons *cannons = &w->cannons;
+    for (int i = 0; i < MAX_CANNONS; i++) {
+        *o++ = cannons->x[i] / GAME_WIDTH;
+        *o++ = cannons->y[i] / GAME_HEIGHT;
+        *o++ = (float) cannons->health[i];
+        *o++ = (float) cannons->bullet[i].state;
+    }
+
+    // one slot per cannon, a cannon has at most one shot in flight
+    const Bullets *bullets = &w->bullets;
+    for (int i = 0; i < MAX_BULLETS; i++) {
+        int n = (cannons->bullet[i].bullet != POOL_NO_HANDLE) ? pool_index(&bullets->pool, cannons->bullet[i].bullet) : -1;
+        *o++ = (n >= 0) ? bullets->x[n] / GAME_WIDTH : 0.0f;
+        *o++ = (n >= 0) ? bullets->y[n] / GAME_HEIGHT : 0.0f;
+        *o++ = (n >= 0) ? 1.0f : 0.0f;
+    }
+
+    const Crates *crates = &w->crates;
+    for (int i = 0; i < MAX_CRATES; i++) {
+        bool present = i < crates->pool.count;
+        *o++ = present ? crates->x[i] / GAME_WIDTH : 0.0f;
+        *o++ = present ? (crates->y[i] + w->scroll) / GAME_HEIGHT : 0.0f;
+        *o++ = present ? 1.0f : 0.0f;
+    }
+}
+
+static void step_range(void *ctx, int begin, int end)
+{
+    VecJob *job = ctx;
+    VecWorlds *v = job->v;
+    const VecConfig *c = &v->config;
+    for (int i = begin; i < end; i++) {
+        World *w = &v->worlds[i];
+        if (job->reset) {
+            start_episode(v, i);
+            v->rewards[i] = 0.0f;
+            v->survived[i] = 0;
+            v->dones[i] = 0;
+            observe(w, &v->obs[(size_t) i * VEC_OBS_SIZE]);
+            continue;
+        }
+
+        SimInput input = unpack_input(v->actions[i] & ~INPUT_DEBUG);
+        bool done = false;
+        int survived = 0;
+        // the episode stops at the tick the player dies, before a reset could clear the inventory
+        int inventory = w->player.inventory;
+        for (int t = 0; t < c->frame_skip && !done; t++) {
+            sim_step(w, input, SIM_DT);
+            input.space_pressed = false;
+            v->episode_ticks[i]++;
+            if (w->player.alive && w->game_state == IN_GAME) survived++;
+            else done = true;
+            if (c->max_episode_ticks > 0 && v->episode_ticks[i] >= c->max_episode_ticks) done = true;
+        }
+
+        v->rewards[i] = (float) (w->player.inventory - inventory);
+        v->survived[i] = survived;
+        v->dones[i] = done;
+        if (done) {
+            v->last_episode_ticks[i] = v->episode_ticks[i];
+            v->last_inventory[i] = w->player.inventory;
+            start_episode(v, i);
+        }
+        observe(w, &v->obs[(size_t) i * VEC_OBS_SIZE]);
+    }
+}
+
+static void run(VecWorlds *v, bool reset)
+{
+    VecJob job = {v, reset};
+    task_pool_run(&v->pool, v->config.count, VEC_GRAIN, step_range, &job);
+}
+
+bool vec_init(VecWorlds *v, const VecConfig *config)
+{
+    memset(v, 0, sizeof(*v));
+    v->config = *config;
+    if (v->config.count < 1) return false;
+    if (v->config.frame_skip < 1) v->config.frame_skip = 1;
+    size_t n = (size_t) v->config.count;
+
+    v->worlds = malloc(n * sizeof(World));
+    v->seeders = malloc(n * sizeof(RngStream));
+    v->actions = calloc(n, sizeof(uint8_t));
+    v->obs = malloc(n * VEC_OBS_SIZE * sizeof(float));
+    v->rewards = malloc(n * sizeof(float));
+    v->survived = malloc(n * sizeof(int));
+    v->dones = malloc(n * sizeof(uint8_t));
+    v->episode_seeds = malloc(n * sizeof(uint64_t));
+    v->episode_ticks = malloc(n * sizeof(int));
+    v->last_episode_ticks = calloc(n, sizeof(int));
+    v->last_inventory = calloc(n, sizeof(int));
+    if (!v->worlds || !v->seeders || !v->actions || !v->obs || !v->rewards || !v->survived || !v->dones ||
+        !v->episode_seeds || !v->episode_ticks || !v->last_episode_ticks || !v->last_inventory) {
+        vec_free(v);
+        return false;
+    }
+    // the dispatch table is filled lazily by sim_init, do it before the workers race for it
+    simd_init();
+    if (!task_pool_init(&v->pool, v->config.threads)) {
+        vec_free(v);
+        return false;
+    }
+    vec_reset(v);
+    return true;
+}
+
+// restarts every world from its seeder's beginning, so a reset batch replays exactly
+void vec_reset(VecWorlds *v)
+{
+    for (int i = 0; i < v->config.count; i++) {
+        v->seeders[i] = rng_stream(v->config.seed ^ VEC_SEED_SALT, (uint32_t) i);
+    }
+    v->episodes = 0;
+    run(v, true);
+}
+
+void vec_step(VecWorlds *v)
+{
+    run(v, false);
+    for (int i = 0; i < v->config.count; i++) v->episodes += v->dones[i];
+}
+
+void vec_free(VecWorlds *v)
+{
+    if (v->pool.count > 0) task_pool_free(&v->pool);
+    free(v->worlds);
+    free(v->seeders);
+    free(v->actions);
+    free(v->obs);
+    free(v->rewards);
+    free(v->survived);
+    free(v->dones);
+    free(v->episode_seeds);
+    free(v->episode_ticks);
+    free(v->last_episode_ticks);
+    free(v->last_inventory);
+    memset(v, 0, sizeof(*v));
+}
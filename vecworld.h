@@ -0,0 +1,61 @@
+#ifndef VECWORLD_H
+#define VECWORLD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sim.h"
+#include "taskpool.h"
+
+// batch of independent worlds stepped in lockstep for balancing runs and training:
+// one action per world in, observations, rewards and done flags out, finished
+// worlds are reset in place with a fresh seed so the batch never drains.
+// each World stays whole so sim_step runs on it untouched, everything the caller
+// reads or writes per step is a flat array indexed by world
+
+// player x, y, inventory, alive
+// per cannon x, y, health, bullet state
+// per bullet slot x, y, present
+// per crate slot x, screen y, present
+#define VEC_OBS_PLAYER 4
+#define VEC_OBS_CANNON 4
+#define VEC_OBS_BULLET 3
+#define VEC_OBS_CRATE 3
+#define VEC_OBS_SIZE (VEC_OBS_PLAYER + VEC_OBS_CANNON * MAX_CANNONS + VEC_OBS_BULLET * MAX_BULLETS + VEC_OBS_CRATE * MAX_CRATES)
+
+#define VEC_GRAIN 64            // worlds per claimed chunk, a few microseconds of work each
+
+typedef struct vec_config {
+    int count;
+    int threads;                // <= 0 takes one per cpu
+    uint64_t seed;
+    int frame_skip;             // ticks per action, space is only pressed on the first
+    int max_episode_ticks;      // 0 runs episodes until the player dies
+    SimParams params;
+} VecConfig;
+
+typedef struct vec_worlds {
+    VecConfig config;
+    World *worlds;
+    RngStream *seeders;         // per world episode seeds, so a run is the same on any thread count
+    // per step, caller writes
+    uint8_t *actions;           // InputBits, INPUT_DEBUG is ignored
+    // per step, vec_step writes
+    float *obs;                 // count * VEC_OBS_SIZE
+    float *rewards;             // inventory gained this step, less any spent on boxes
+    int *survived;              // ticks of this step the player was alive for, frame_skip unless it died
+    uint8_t *dones;             // the episode ended this step and the world has been reset
+    // per world bookkeeping
+    uint64_t *episode_seeds;
+    int *episode_ticks;
+    int *last_episode_ticks;    // length and final inventory of the last finished episode
+    int *last_inventory;
+    uint64_t episodes;
+    TaskPool pool;
+} VecWorlds;
+
+bool vec_init(VecWorlds *v, const VecConfig *config);
+void vec_reset(VecWorlds *v);
+void vec_step(VecWorlds *v);
+void vec_free(VecWorlds *v);
+
+#endif